@@ -0,0 +1,388 @@
+// Microbenchmark entry point (env:bench)
+// Times the detection and rendering hot paths on the host: each benchmark
+// runs warmup repetitions, then timed repetitions whose ns per operation
+// are summarized (median, mean, standard deviation, min, max). Results can
+// be written as JSON lines and compared with an earlier run.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "Platform.h"
+#include "config.h"
+#include "BreathData.h"
+#include "BreathTrace.h"
+#include "Display.h"
+#include "HudText.h"
+#include "NumberFormat.h"
+#include "PressureFilter.h"
+#include "RenderScript.h"
+#include "modes/live_mode.h"
+#include "modes/diagnostic_mode.h"
+
+extern SerialMock Serial;
+
+// Trace length for the detection benchmarks (synthetic breathing at the
+// sampling rate)
+static const uint32_t SYNTHETIC_TRACE_MS = 3600000;
+
+// Operations per repetition of the fixed-size benchmarks
+static const int RGB565_COLORS = 65536;
+static const int WAVE_FRAMES = 2000;
+static const int RENDER_FRAMES = 200;
+static const int FORMAT_VALUES = 20000;
+
+struct BenchOptions {
+  int reps = 15;
+  int warmup = 3;
+  const char* filter = nullptr;    // Run only names containing this
+  const char* tracePath = nullptr; // Recorded trace instead of synthetic
+  const char* jsonPath = nullptr;  // JSON lines output
+  const char* comparePath = nullptr;
+};
+
+// Runs one repetition and returns the operations it did
+typedef size_t (*BenchFunction)();
+
+struct Benchmark {
+  const char* name;
+  const char* op;  // What one operation is
+  BenchFunction run;
+};
+
+// ns per operation over the timed repetitions
+struct BenchResult {
+  const Benchmark* bench;
+  size_t ops;
+  double median;
+  double mean;
+  double stddev;
+  double min;
+  double max;
+};
+
+// Results feed this so the compiler cannot drop the work
+static volatile uint32_t sink;
+
+// ========================================
+// Inputs
+// ========================================
+static std::vector<Sample> trace;
+static unsigned long traceSpanMs = 0;
+
+static bool loadTrace(const BenchOptions& options) {
+  TracePoint point;
+  float baseline = 0;
+  if (options.tracePath) {
+    TraceReplay replay;
+    if (!replay.load(options.tracePath)) return false;
+    while (replay.next(point)) {
+      if (trace.empty()) baseline = point.pressure;
+      trace.push_back({ point.timestamp, point.pressure - baseline, 0, 0,
+                        point.pressure, point.temperature });
+    }
+  } else {
+    SyntheticBreathParams params;
+    params.sampleRateHz = 1000.0f / SAMPLE_PERIOD_MS;
+    SyntheticBreath synthetic;
+    synthetic.init(params);
+    baseline = params.baselinePa;
+    do {
+      point = synthetic.next();
+      trace.push_back({ point.timestamp, point.pressure - baseline, 0, 0,
+                        point.pressure, point.temperature });
+    } while (point.timestamp - trace.front().timestamp < SYNTHETIC_TRACE_MS);
+  }
+  if (trace.empty()) return false;
+  traceSpanMs = trace.back().timestamp - trace.front().timestamp + SAMPLE_PERIOD_MS;
+  return true;
+}
+
+// ========================================
+// Benchmarks
+// ========================================
+static BreathData benchData;
+
+// BreathData::detect() per sample. Timestamps keep increasing across
+// repetitions, as a session would.
+static size_t benchDetect() {
+  static unsigned long offset = 0;
+  for (const Sample& sample : trace) {
+    benchData.detect(sample.pressureDelta, sample.timestamp + offset);
+  }
+  offset += traceSpanMs;
+  sink += benchData.getBreathCount();
+  return trace.size();
+}
+
+// The detection task's pass: PressureFilter then detectBlock() per block
+static size_t benchDetectBlock() {
+  static PressureFilter filter;
+  static unsigned long offset = 0;
+  static bool filterReady = false;
+  if (!filterReady) {
+    filter.init(1000.0f / SAMPLE_PERIOD_MS);
+    filterReady = true;
+  }
+
+  Sample block[FILTER_BLOCK_SIZE];
+  float deltas[FILTER_BLOCK_SIZE];
+  for (size_t start = 0; start < trace.size(); start += FILTER_BLOCK_SIZE) {
+    size_t count = trace.size() - start;
+    if (count > FILTER_BLOCK_SIZE) count = FILTER_BLOCK_SIZE;
+    for (size_t i = 0; i < count; i++) {
+      block[i] = trace[start + i];
+      block[i].timestamp += offset;
+      deltas[i] = block[i].pressureDelta;
+    }
+    filter.process(deltas, count);
+    for (size_t i = 0; i < count; i++) {
+      block[i].pressureDelta = deltas[i];
+    }
+    sink += benchData.detectBlock(block, count);
+  }
+  offset += traceSpanMs;
+  return trace.size();
+}
+
+// Display::rgb565() on colors the compiler cannot precompute
+static size_t benchRgb565() {
+  uint32_t seed = sink;
+  uint32_t sum = 0;
+  for (int i = 0; i < RGB565_COLORS; i++) {
+    uint32_t rgb = i * 2654435761u + seed;
+    sum += Display::rgb565(rgb >> 16, rgb >> 8, rgb);
+  }
+  sink = sum;
+  return RGB565_COLORS;
+}
+
+// Live mode's per-frame wave synthesis without drawing, on the
+// render check's scripted breath
+static size_t benchLiveWave() {
+  for (int frame = 0; frame < WAVE_FRAMES; frame++) {
+    updateLiveWave(scriptedBreath((float)frame / WAVE_UPDATE_FPS), 1.0f / WAVE_UPDATE_FPS);
+  }
+  return WAVE_FRAMES;
+}
+
+// Whole frames of a scripted mode: the --bench-render path, continuing
+// through the script across repetitions
+static size_t benchScriptedFrames(AppMode appMode, int& nextFrame) {
+  for (int m = 0; m < SCRIPTED_MODE_COUNT; m++) {
+    const ScriptedMode& mode = scriptedModes[m];
+    if (mode.mode != appMode) continue;
+    drawScriptedFrames(mode, nextFrame, RENDER_FRAMES);
+    nextFrame = (nextFrame + RENDER_FRAMES) % scriptFrameCount(mode);
+  }
+  return RENDER_FRAMES;
+}
+
+// Whole live frames: synthesis, strips, diff and panel copy
+static size_t benchLiveFrame() {
+  static int nextFrame = 0;
+  return benchScriptedFrames(MODE_LIVE, nextFrame);
+}
+
+// Whole diagnostic frames: mostly HudText over a cleared strip
+static size_t benchDiagnosticFrame() {
+  static int nextFrame = 0;
+  return benchScriptedFrames(MODE_DIAGNOSTIC, nextFrame);
+}
+
+// The diagnostic numbers' formatter on its own
+static size_t benchFormatFloat() {
+  char text[NUMBER_TEXT_SIZE];
+  uint32_t sum = 0;
+  for (int i = 0; i < FORMAT_VALUES; i++) {
+    float value = (i - FORMAT_VALUES / 2) * 0.0731f;
+    sum += formatFloat(text, value, i % 4);
+  }
+  sink += sum;
+  return FORMAT_VALUES;
+}
+
+static const Benchmark benchmarks[] = {
+  { "detect", "sample", benchDetect },
+  { "detect_block_filtered", "sample", benchDetectBlock },
+  { "rgb565", "color", benchRgb565 },
+  { "live_wave", "frame", benchLiveWave },
+  { "live_frame", "frame", benchLiveFrame },
+  { "diagnostic_frame", "frame", benchDiagnosticFrame },
+  { "format_float", "value", benchFormatFloat },
+};
+
+// ========================================
+// Runner
+// ========================================
+static BenchResult runBenchmark(const Benchmark& bench, const BenchOptions& options) {
+  for (int i = 0; i < options.warmup; i++) {
+    bench.run();
+  }
+
+  std::vector<double> nsPerOp;
+  size_t ops = 0;
+  for (int i = 0; i < options.reps; i++) {
+    auto start = std::chrono::steady_clock::now();
+    ops = bench.run();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    nsPerOp.push_back(ns / ops);
+  }
+
+  std::sort(nsPerOp.begin(), nsPerOp.end());
+  BenchResult result = { &bench, ops, 0, 0, 0, nsPerOp.front(), nsPerOp.back() };
+  size_t n = nsPerOp.size();
+  result.median = n % 2 ? nsPerOp[n / 2] : (nsPerOp[n / 2 - 1] + nsPerOp[n / 2]) / 2;
+  for (double value : nsPerOp) result.mean += value;
+  result.mean /= n;
+  for (double value : nsPerOp) result.stddev += (value - result.mean) * (value - result.mean);
+  result.stddev = n > 1 ? sqrt(result.stddev / (n - 1)) : 0;
+  return result;
+}
+
+// One JSON object per line, in benchmark order, so runs diff line by line
+static bool writeJson(const char* path, const std::vector<BenchResult>& results, int reps) {
+  FILE* file = fopen(path, "w");
+  if (!file) {
+    Serial.print("Cannot write ");
+    Serial.println(path);
+    return false;
+  }
+  for (const BenchResult& result : results) {
+    fprintf(file, "{\"bench\":\"%s\",\"op\":\"%s\",\"ops\":%zu,\"reps\":%d,"
+                  "\"median_ns\":%.3f,\"mean_ns\":%.3f,\"stddev_ns\":%.3f,"
+                  "\"min_ns\":%.3f,\"max_ns\":%.3f}\n",
+            result.bench->name, result.bench->op, result.ops, reps,
+            result.median, result.mean, result.stddev, result.min, result.max);
+  }
+  fclose(file);
+  return true;
+}
+
+// Median of a benchmark in an earlier --json file, or -1
+static double baselineMedian(const char* path, const char* name) {
+  FILE* file = fopen(path, "r");
+  if (!file) return -1;
+  char line[512];
+  char key[64];
+  snprintf(key, sizeof(key), "{\"bench\":\"%s\",", name);
+  double median = -1;
+  while (fgets(line, sizeof(line), file)) {
+    const char* field = strstr(line, "\"median_ns\":");
+    if (!strncmp(line, key, strlen(key)) && field) {
+      median = atof(field + strlen("\"median_ns\":"));
+    }
+  }
+  fclose(file);
+  return median;
+}
+
+static void printResult(const BenchResult& result, const BenchOptions& options) {
+  Serial.print(result.bench->name);
+  Serial.print(": ");
+  Serial.print((float)result.median, 2);
+  Serial.print(" ns/");
+  Serial.print(result.bench->op);
+  Serial.print(" median (mean ");
+  Serial.print((float)result.mean, 2);
+  Serial.print(", sd ");
+  Serial.print((float)result.stddev, 2);
+  Serial.print(", min ");
+  Serial.print((float)result.min, 2);
+  Serial.print(", max ");
+  Serial.print((float)result.max, 2);
+  Serial.print(") x ");
+  Serial.print((int)result.ops);
+  Serial.print(" ops, ");
+  Serial.print(options.reps);
+  Serial.print(" reps");
+
+  if (options.comparePath) {
+    double before = baselineMedian(options.comparePath, result.bench->name);
+    if (before > 0) {
+      Serial.print(" [");
+      Serial.print((float)before, 2);
+      Serial.print(" -> ");
+      Serial.print((float)result.median, 2);
+      Serial.print(", ");
+      float change = (float)(100.0 * (result.median - before) / before);
+      if (change >= 0) Serial.print("+");
+      Serial.print(change, 1);
+      Serial.print("%]");
+    }
+  }
+  Serial.println("");
+}
+
+static void printUsage() {
+  Serial.println("Usage: program [options]");
+  Serial.println("  --reps N         Timed repetitions per benchmark (default 15)");
+  Serial.println("  --warmup N       Untimed repetitions first (default 3)");
+  Serial.println("  --filter TEXT    Only benchmarks whose name contains TEXT");
+  Serial.println("  --trace FILE     Detect over a recorded trace instead of 1 h synthetic");
+  Serial.println("  --json FILE      Also write the results as JSON lines");
+  Serial.println("  --compare FILE   Show the median change against an earlier --json file");
+  Serial.print("Benchmarks:");
+  for (const Benchmark& bench : benchmarks) {
+    Serial.print(" ");
+    Serial.print(bench.name);
+  }
+  Serial.println("");
+}
+
+static bool parseBenchArgs(int argc, char* argv[], BenchOptions& options) {
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    bool hasValue = i + 1 < argc;
+
+    if (!strcmp(arg, "--reps") && hasValue) {
+      options.reps = atoi(argv[++i]);
+    } else if (!strcmp(arg, "--warmup") && hasValue) {
+      options.warmup = atoi(argv[++i]);
+    } else if (!strcmp(arg, "--filter") && hasValue) {
+      options.filter = argv[++i];
+    } else if (!strcmp(arg, "--trace") && hasValue) {
+      options.tracePath = argv[++i];
+    } else if (!strcmp(arg, "--json") && hasValue) {
+      options.jsonPath = argv[++i];
+    } else if (!strcmp(arg, "--compare") && hasValue) {
+      options.comparePath = argv[++i];
+    } else {
+      printUsage();
+      return false;
+    }
+  }
+  if (options.reps < 1 || options.warmup < 0) {
+    printUsage();
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+  BenchOptions options;
+  if (!parseBenchArgs(argc, argv, options)) return 1;
+
+  if (!loadTrace(options)) {
+    Serial.println("No trace samples");
+    return 1;
+  }
+  benchData.init();
+  display.init();
+  glyphAtlas.init();
+
+  Serial.print("Trace: ");
+  Serial.print((int)trace.size());
+  Serial.print(" samples (");
+  Serial.print(traceSpanMs / 1000.0f, 0);
+  Serial.println(" s)");
+
+  std::vector<BenchResult> results;
+  for (const Benchmark& bench : benchmarks) {
+    if (options.filter && !strstr(bench.name, options.filter)) continue;
+    results.push_back(runBenchmark(bench, options));
+    printResult(results.back(), options);
+  }
+
+  if (options.jsonPath && !writeJson(options.jsonPath, results, options.reps)) return 1;
+  return 0;
+}
@@ -0,0 +1,181 @@
+// Recorded trace replay and synthetic breathing for the simulator sensor
+#include "BreathTrace.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+// ========================================
+// TraceReplay
+// ========================================
+TraceReplay::~TraceReplay() {
+  free(points);
+}
+
+bool TraceReplay::load(const char* path) {
+  FILE* file = fopen(path, "r");
+  if (!file) return false;
+
+  free(points);
+  points = nullptr;
+  count = 0;
+  size_t capacity = 0;
+
+  char line[128];
+  while (fgets(line, sizeof(line), file)) {
+    TracePoint point;
+    // Skips the header and any malformed lines
+    if (sscanf(line, "%lu,%f,%f", &point.timestamp, &point.pressure, &point.temperature) != 3) {
+      continue;
+    }
+    if (count == capacity) {
+      capacity = capacity ? capacity * 2 : 1024;
+      TracePoint* grown = (TracePoint*)realloc(points, capacity * sizeof(TracePoint));
+      if (!grown) break;
+      points = grown;
+    }
+    points[count++] = point;
+  }
+  fclose(file);
+
+  rewind();
+  return count > 0;
+}
+
+void TraceReplay::rewind() {
+  index = 0;
+  loopOffset = 0;
+}
+
+bool TraceReplay::next(TracePoint& point) {
+  if (index >= count) {
+    if (!loop || count == 0) return false;
+
+    // Continue the timeline one average sample period after the last point
+    unsigned long span = points[count - 1].timestamp - points[0].timestamp;
+    unsigned long period = count > 1 ? span / (count - 1) : 1;
+    loopOffset += span + period;
+    index = 0;
+  }
+
+  point = points[index++];
+  point.timestamp += loopOffset;
+  return true;
+}
+
+// ========================================
+// SyntheticBreath
+// ========================================
+bool parseSyntheticParams(const char* spec, SyntheticBreathParams& params) {
+  if (!spec || !*spec) return true;
+
+  char buffer[256];
+  strncpy(buffer, spec, sizeof(buffer) - 1);
+  buffer[sizeof(buffer) - 1] = '\0';
+
+  for (char* item = strtok(buffer, ","); item; item = strtok(nullptr, ",")) {
+    char* eq = strchr(item, '=');
+    if (!eq) return false;
+    *eq = '\0';
+    float value = strtof(eq + 1, nullptr);
+
+    if (!strcmp(item, "rate"))          params.rateBpm = value;
+    else if (!strcmp(item, "depth"))    params.depthPa = value;
+    else if (!strcmp(item, "inhale"))   params.inhaleFraction = value;
+    else if (!strcmp(item, "hold-in"))  params.holdAfterInhaleMs = value;
+    else if (!strcmp(item, "hold-out")) params.holdAfterExhaleMs = value;
+    else if (!strcmp(item, "drift"))    params.driftPaPerMin = value;
+    else if (!strcmp(item, "noise"))    params.noisePa = value;
+    else if (!strcmp(item, "lead-in"))  params.leadInMs = value;
+    else if (!strcmp(item, "hz"))       params.sampleRateHz = value;
+    else if (!strcmp(item, "seed"))     params.seed = (unsigned)value;
+    else return false;
+  }
+
+  return params.rateBpm > 0 && params.sampleRateHz > 0 &&
+         params.inhaleFraction > 0 && params.inhaleFraction < 1;
+}
+
+void SyntheticBreath::init(const SyntheticBreathParams& newParams) {
+  params = newParams;
+  rngState = params.seed ? params.seed : 1;
+  sampleIndex = 0;
+}
+
+float SyntheticBreath::gaussian() {
+  // xorshift32
+  auto uniform = [this]() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return (rngState >> 8) * (1.0f / 16777216.0f);
+  };
+
+  float u1 = uniform();
+  float u2 = uniform();
+  if (u1 < 1e-7f) u1 = 1e-7f;
+  return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
+
+float SyntheticBreath::shapeAt(float cycleMs) const {
+  float periodMs = 60000.0f / params.rateBpm;
+  float activeMs = periodMs - params.holdAfterInhaleMs - params.holdAfterExhaleMs;
+  if (activeMs < 1.0f) activeMs = 1.0f;
+
+  float inhaleMs = activeMs * params.inhaleFraction;
+  float exhaleMs = activeMs - inhaleMs;
+
+  // Inhale (negative), hold, exhale (positive), pause
+  if (cycleMs < inhaleMs) {
+    return -params.depthPa * sinf((float)M_PI * cycleMs / inhaleMs);
+  }
+  cycleMs -= inhaleMs;
+  if (cycleMs < params.holdAfterInhaleMs) return 0;
+  cycleMs -= params.holdAfterInhaleMs;
+  if (cycleMs < exhaleMs) {
+    return params.depthPa * sinf((float)M_PI * cycleMs / exhaleMs);
+  }
+  return 0;
+}
+
+TracePoint SyntheticBreath::next() {
+  double timeMs = sampleIndex * 1000.0 / params.sampleRateHz;
+  sampleIndex++;
+
+  double breathingMs = timeMs - params.leadInMs;
+  float breath = 0;
+  if (breathingMs >= 0) {
+    double periodMs = 60000.0 / params.rateBpm;
+    breath = shapeAt((float)fmod(breathingMs, periodMs));
+  }
+
+  float drift = params.driftPaPerMin * (float)(timeMs / 60000.0);
+
+  TracePoint point;
+  point.timestamp = (unsigned long)timeMs;
+  point.pressure = params.baselinePa + drift + breath + params.noisePa * gaussian();
+  point.temperature = params.temperatureC;
+  return point;
+}
+
+// ========================================
+// TraceRecorder
+// ========================================
+bool TraceRecorder::open(const char* path) {
+  close();
+  file = fopen(path, "w");
+  if (!file) return false;
+  fprintf(file, "timestamp_ms,pressure_pa,temperature_c\n");
+  return true;
+}
+
+void TraceRecorder::close() {
+  if (file) {
+    fclose(file);
+    file = nullptr;
+  }
+}
+
+void TraceRecorder::write(const TracePoint& point) {
+  if (!file) return;
+  fprintf(file, "%lu,%.3f,%.2f\n", point.timestamp, point.pressure, point.temperature);
+}
@@ -0,0 +1,104 @@
+#ifndef BREATH_TRACE_H
+#define BREATH_TRACE_H
+
+// Simulator sensor sources: recorded trace replay and synthetic breathing.
+// Traces are CSV files with one reading per line:
+//   timestamp_ms,pressure_pa,temperature_c
+
+// Only C headers here: this is included after Arduino.h, whose min/max
+// macros break <vector> and <random>.
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// One sensor reading
+struct TracePoint {
+  unsigned long timestamp;  // ms
+  float pressure;           // Pa (absolute)
+  float temperature;        // C
+};
+
+// Replays a recorded trace file
+class TraceReplay {
+public:
+  ~TraceReplay();
+
+  // Load a CSV trace; returns false if the file is missing or empty
+  bool load(const char* path);
+
+  // Restart from the first point
+  void rewind();
+
+  // Next point in file order. When looping, timestamps keep increasing
+  // across repetitions. Returns false at the end of a non-looping trace.
+  bool next(TracePoint& point);
+
+  void setLoop(bool enabled) { loop = enabled; }
+  bool isFinished() const { return !loop && index >= count; }
+  size_t size() const { return count; }
+
+private:
+  TracePoint* points = nullptr;
+  size_t count = 0;
+  size_t index = 0;
+  unsigned long loopOffset = 0;
+  bool loop = false;
+};
+
+// Parameters for synthetic breathing
+struct SyntheticBreathParams {
+  float rateBpm = 12.0f;          // Breath cycles per minute (including holds)
+  float depthPa = 30.0f;          // Peak pressure delta of inhale/exhale
+  float inhaleFraction = 0.4f;    // Share of the active cycle spent inhaling
+  float holdAfterInhaleMs = 0;    // Breath hold at full lungs
+  float holdAfterExhaleMs = 0;    // Pause at empty lungs
+  float driftPaPerMin = 0;        // Baseline drift (e.g. weather, temperature)
+  float noisePa = 0.5f;           // RMS sensor noise
+  float leadInMs = 1500.0f;       // Quiet start so baseline calibration is unbiased
+  float sampleRateHz = 100.0f;    // Points generated per second of trace time
+  float baselinePa = 101325.0f;
+  float temperatureC = 22.0f;
+  unsigned seed = 1;
+};
+
+// Parse "rate=12,depth=30,hold-in=2000,..." into params (unknown keys fail).
+// Keys: rate, depth, inhale, hold-in, hold-out, drift, noise, lead-in, hz, seed
+bool parseSyntheticParams(const char* spec, SyntheticBreathParams& params);
+
+// Generates a parameterized, repeatable breathing trace
+class SyntheticBreath {
+public:
+  void init(const SyntheticBreathParams& params);
+
+  // Next point, one sample period after the previous one
+  TracePoint next();
+
+  const SyntheticBreathParams& getParams() const { return params; }
+
+private:
+  // Pressure delta at a time within the breath cycle (ms)
+  float shapeAt(float cycleMs) const;
+
+  // Repeatable unit-variance Gaussian noise (xorshift32 + Box-Muller)
+  float gaussian();
+
+  SyntheticBreathParams params;
+  uint32_t rngState = 1;
+  uint64_t sampleIndex = 0;
+};
+
+// Writes readings to a CSV trace file
+class TraceRecorder {
+public:
+  ~TraceRecorder() { close(); }
+
+  bool open(const char* path);
+  void close();
+  void write(const TracePoint& point);
+  bool isOpen() const { return file != nullptr; }
+
+private:
+  FILE* file = nullptr;
+};
+
+#endif // BREATH_TRACE_H
@@ -1,16 +1,144 @@
 // Simulator implementation of Display
-// Uses Adafruit GFXcanvas16 for rendering, SDL2 for display
+// Uses Adafruit GFX strip canvases for rendering, SDL2 for display
+// (HEADLESS builds keep the panel image only, with synchronous blits)
+
+// Standard headers first: the simulator's Arduino.h min/max macros break them
+#ifndef HEADLESS
+  #include <chrono>
+  #include <condition_variable>
+  #include <mutex>
+  #include <thread>
+#endif
+
 #include "Display.h"
 #include "config.h"
+#include "LatencyTrace.h"
 #include "Platform.h"
 
-static GFXcanvas16* canvas = nullptr;
+static_assert(SCREEN_HEIGHT % DISPLAY_STRIP_ROWS == 0, "DISPLAY_STRIP_ROWS must divide SCREEN_HEIGHT");
+
+static FrameCanvas* strips[DISPLAY_BUFFERS] = {};
+static FrameDiff frameDiff;
+static BlitStats blitStats;
+
+// Buffer the next strip is drawn into
+static int drawIndex = 0;
+
+// Palette of the frame being drawn, and of the last frame sent.
+// Messages use their own two-color palette.
+static Palette messagePalette;
+static const Palette* drawPalette = &messagePalette;
+static const Palette* sentPalette = nullptr;
+
+// What the ST7735 would show (RGB565)
+static uint16_t panel[SCREEN_WIDTH * SCREEN_HEIGHT];
+
+// Copy a strip's sent rows into the panel, expanding palette indices to
+// RGB565 on the way
+static void copySpans(const Pixel* pixels, int originY, const uint16_t* palette,
+                      const RowSpan* spans, int count) {
+  for (int i = 0; i < count; i++) {
+    uint16_t* target = panel + spans[i].y * SCREEN_WIDTH;
+    const Pixel* source = pixels + (spans[i].y - originY) * SCREEN_WIDTH;
+    int pixelCount = spans[i].height * SCREEN_WIDTH;
+#if DISPLAY_INDEXED_COLOR
+    for (int p = 0; p < pixelCount; p++) {
+      target[p] = palette[source[p]];
+    }
+#else
+    memcpy(target, source, pixelCount * sizeof(uint16_t));
+#endif
+  }
+}
+
+#ifndef HEADLESS
 static SDL_Window* window = nullptr;
 static SDL_Renderer* renderer = nullptr;
 static SDL_Texture* texture = nullptr;
 static const int SCALE = 4;
 
+// Background "SPI transfer" into a panel image, mimicking the ESP32 blit
+// task. SDL calls stay on the main thread, which presents the panel.
+static const uint32_t SPI_CLOCK_HZ = 24000000;  // Modeled ST7735 SPI clock
+
+struct BlitRequest {
+  int buffer;
+  int originY;
+  const uint16_t* palette;
+  int spanCount;
+  RowSpan spans[BLIT_MAX_SPANS];
+};
+
+static std::mutex blitMutex;
+static std::condition_variable blitSignal;
+static BlitRequest queue[DISPLAY_BUFFERS];
+static int queueHead = 0;
+static int queueCount = 0;
+static bool inFlight[DISPLAY_BUFFERS] = {};
+static uint32_t transferEndMicros[DISPLAY_BUFFERS] = {};
+static bool panelChanged = false;
+
+static void blitThread() {
+  while (true) {
+    BlitRequest request;
+    {
+      std::unique_lock<std::mutex> lock(blitMutex);
+      blitSignal.wait(lock, [] { return queueCount > 0; });
+      request = queue[queueHead];
+    }
+
+    // Copy the spans as the panel would receive them, taking as long as
+    // the bytes would take on the SPI bus
+    {
+      std::lock_guard<std::mutex> lock(blitMutex);
+      copySpans(strips[request.buffer]->getBuffer(), request.originY, request.palette,
+                request.spans, request.spanCount);
+    }
+    uint64_t bits = 8ULL * FrameDiff::transferBytes(request.spans, request.spanCount);
+    std::this_thread::sleep_for(std::chrono::microseconds(bits * 1000000 / SPI_CLOCK_HZ));
+
+    std::lock_guard<std::mutex> lock(blitMutex);
+    queueHead = (queueHead + 1) % DISPLAY_BUFFERS;
+    queueCount--;
+    inFlight[request.buffer] = false;
+    transferEndMicros[request.buffer] = micros();
+    panelChanged = true;
+    blitSignal.notify_all();
+  }
+}
+
+// Wait for a buffer's transfer to finish
+static void acquireBuffer(int buffer) {
+  uint32_t endMicros;
+  {
+    std::unique_lock<std::mutex> lock(blitMutex);
+    blitSignal.wait(lock, [buffer] { return !inFlight[buffer]; });
+    endMicros = transferEndMicros[buffer];
+  }
+  latencyTrace.completeFrame(buffer, endMicros);
+}
+
+// Show the panel image if a transfer has finished since the last call
+static void present() {
+  {
+    std::lock_guard<std::mutex> lock(blitMutex);
+    if (!panelChanged) return;
+    panelChanged = false;
+    SDL_UpdateTexture(texture, nullptr, panel, SCREEN_WIDTH * sizeof(uint16_t));
+  }
+  SDL_RenderClear(renderer);
+  SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+  SDL_RenderPresent(renderer);
+}
+#endif
+
 void Display::init() {
+#ifdef HEADLESS
+  for (int i = 0; i < DISPLAY_BUFFERS; i++) {
+    strips[i] = new FrameCanvas(DISPLAY_STRIP_ROWS);
+  }
+  Serial.println("Headless display initialized");
+#else
   Serial.println("Initializing SDL2 display...");
 
   window = SDL_CreateWindow(
@@ -46,38 +174,126 @@ void Display::init() {
     return;
   }
 
-  // Use the real Adafruit GFXcanvas16!
-  canvas = new GFXcanvas16(SCREEN_WIDTH, SCREEN_HEIGHT);
+  // Strips are real Adafruit GFX canvases!
+  for (int i = 0; i < DISPLAY_BUFFERS; i++) {
+    strips[i] = new FrameCanvas(DISPLAY_STRIP_ROWS);
+  }
+  std::thread(blitThread).detach();
 
   Serial.println("SDL2 display initialized successfully!");
+#endif
 }
 
-Canvas& Display::getCanvas() {
-  return *canvas;
+void Display::setPalette(const Palette& palette) {
+  drawPalette = &palette;
 }
 
-void Display::blit() {
-  // Copy GFXcanvas16 buffer directly to SDL texture
-  SDL_UpdateTexture(texture, nullptr, canvas->getBuffer(), SCREEN_WIDTH * sizeof(uint16_t));
-  SDL_RenderClear(renderer);
-  SDL_RenderCopy(renderer, texture, nullptr, nullptr);
-  SDL_RenderPresent(renderer);
+const BlitStats& Display::getBlitStats() const {
+  return blitStats;
 }
 
-void Display::clear() {
-  canvas->fillScreen(ST77XX_BLACK);
-  blit();
+void Display::render(SceneFunction scene) {
+  // The same indices mean different colors under a new palette
+  if (DISPLAY_INDEXED_COLOR && drawPalette != sentPalette) frameDiff.invalidate();
+  sentPalette = drawPalette;
+
+  uint32_t frameBytes = 0;
+  for (int y = 0; y < SCREEN_HEIGHT; y += DISPLAY_STRIP_ROWS) {
+#ifndef HEADLESS
+    acquireBuffer(drawIndex);  // The fence
+#endif
+    FrameCanvas& strip = *strips[drawIndex];
+    strip.setOriginY(y);
+    scene(strip);
+
+    // Rows the ST7735 path would send
+    RowSpan spans[BLIT_MAX_SPANS];
+    int count = frameDiff.diff(strip.getBuffer(), y, DISPLAY_STRIP_ROWS, spans, BLIT_MAX_SPANS);
+    frameBytes += FrameDiff::transferBytes(spans, count);
+
+    if (y == 0) latencyTrace.mark(LATENCY_BLIT_START);
+    bool lastStrip = y + DISPLAY_STRIP_ROWS >= SCREEN_HEIGHT;
+    if (lastStrip) latencyTrace.submitFrame(drawIndex);
+
+#ifdef HEADLESS
+    copySpans(strip.getBuffer(), y, drawPalette->colors, spans, count);
+    if (lastStrip) latencyTrace.completeFrame(drawIndex, micros());
+#else
+    {
+      std::lock_guard<std::mutex> lock(blitMutex);
+      BlitRequest& request = queue[(queueHead + queueCount) % DISPLAY_BUFFERS];
+      request.buffer = drawIndex;
+      request.originY = y;
+      request.palette = drawPalette->colors;
+      request.spanCount = count;
+      memcpy(request.spans, spans, count * sizeof(RowSpan));
+      queueCount++;
+      inFlight[drawIndex] = true;
+    }
+    blitSignal.notify_all();
+#endif
+
+    // Draw the next strip into the other buffer
+    drawIndex = (drawIndex + 1) % DISPLAY_BUFFERS;
+  }
+  blitStats.add(frameBytes);
+
+#ifndef HEADLESS
+  present();
+#endif
 }
 
-void Display::showMessage(const char* message, uint16_t color) {
-  canvas->fillScreen(ST77XX_BLACK);
-  canvas->setCursor(10, SCREEN_HEIGHT / 2 - 10);
-  canvas->setTextColor(color);
-  canvas->setTextSize(1);
-  canvas->print(message);
-  blit();
+#ifdef HEADLESS
+const uint16_t* Display::getPanel() const {
+  return panel;
+}
+#endif
+
+void Display::waitForBlit() {
+#ifndef HEADLESS
+  for (int i = 0; i < DISPLAY_BUFFERS; i++) {
+    acquireBuffer(i);
+  }
+  present();
+#endif
+}
+
+// Message shown by the message scene
+static const char* messageText = "";
+static uint16_t messageColor = ST77XX_BLACK;
+
+static void drawMessage(FrameCanvas& canvas) {
+  canvas.fillScreen(messagePalette.pixel(ST77XX_BLACK));
+  canvas.setCursor(10, SCREEN_HEIGHT / 2 - 10);
+  canvas.setTextColor(messagePalette.pixel(messageColor));
+  canvas.setTextSize(1);
+  canvas.print(messageText);
 }
 
-uint16_t Display::rgb565(uint8_t r, uint8_t g, uint8_t b) {
-  return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+// Message frames are waited for on both sides, so this palette is never
+// being sent when it changes. Its colors do change in place, so the
+// next frame resends every row.
+static void setMessage(const char* message, uint16_t color) {
+  messageText = message;
+  messageColor = color;
+  messagePalette = Palette();
+  messagePalette.add(ST77XX_BLACK);
+  messagePalette.add(color);
+  sentPalette = nullptr;
+}
+
+void Display::clear() {
+  waitForBlit();
+  setMessage("", ST77XX_BLACK);
+  setPalette(messagePalette);
+  render(drawMessage);
+  waitForBlit();
+}
+
+void Display::showMessage(const char* message, uint16_t color) {
+  waitForBlit();
+  setMessage(message, color);
+  setPalette(messagePalette);
+  render(drawMessage);
+  waitForBlit();
 }
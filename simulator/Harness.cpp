@@ -0,0 +1,668 @@
+// Headless self-checks
+#include <chrono>
+#include <cstddef>
+#include <vector>
+#include <sys/stat.h>
+#include "Harness.h"
+#include "BreathDetector.h"
+#include "Crc32.h"
+#include "Display.h"
+#include "FixedPoint.h"
+#include "HudText.h"
+#include "LatencyTrace.h"
+#include "NumberFormat.h"
+#include "Raster.h"
+#include "RenderScript.h"
+#include "Sensor.h"
+#include "Settings.h"
+#include "Storage.h"
+#include "config.h"
+
+extern SerialMock Serial;
+void setup();
+
+// Transitions printed in detail before the report is summarized
+static const int MAX_REPORTED_MISMATCHES = 10;
+
+// Frames drawn per path by the raster benchmark
+static const int RASTER_BENCH_FRAMES = 20000;
+
+// Frames drawn per path and values formatted by the text benchmark
+static const int TEXT_BENCH_FRAMES = 20000;
+static const int TEXT_CHECK_VALUES = 100000;
+
+// Frames drawn per mode by the render benchmark (the script repeats)
+static const int RENDER_BENCH_FRAMES = 6000;
+
+static const char* stateName(BreathState state) {
+  switch (state) {
+    case BREATH_INHALE: return "INHALE";
+    case BREATH_EXHALE: return "EXHALE";
+    case BREATH_HOLD: return "HOLD";
+    default: return "IDLE";
+  }
+}
+
+int runFixedPointCheck(const SimulatorOptions& options) {
+  // Every trace point exactly once, as fast as it can be processed
+  pressureSensor.setFreeRunning(true);
+  setup();
+
+  BreathDetector<float> floatDetector;
+  BreathDetector<Q16> fixedDetector;
+  floatDetector.reset();
+  fixedDetector.reset();
+  floatDetector.setThresholds(DEFAULT_INHALE_THRESHOLD, DEFAULT_EXHALE_THRESHOLD);
+  fixedDetector.setThresholds(DEFAULT_INHALE_THRESHOLD, DEFAULT_EXHALE_THRESHOLD);
+
+  unsigned long samples = 0;
+  unsigned long transitions = 0;
+  unsigned long mismatches = 0;
+  float maxNormalizedError = 0;
+  unsigned long startTime = 0;
+
+  while (!pressureSensor.isTraceFinished()) {
+    pressureSensor.update();
+    unsigned long now = pressureSensor.getSampleTime();
+    float delta = pressureSensor.getDelta();
+
+    if (samples == 0) startTime = now;
+    if (now - startTime >= options.durationMs) break;
+    samples++;
+
+    bool floatChanged = floatDetector.detect(delta, now);
+    bool fixedChanged = fixedDetector.detect(Q16(delta), now);
+    if (floatChanged) transitions++;
+
+    if (floatChanged != fixedChanged || floatDetector.getState() != fixedDetector.getState()) {
+      if (mismatches < MAX_REPORTED_MISMATCHES) {
+        Serial.print("Mismatch at ");
+        Serial.print((int)(now - startTime));
+        Serial.print(" ms, delta ");
+        Serial.print(delta, 4);
+        Serial.print(" Pa: float ");
+        Serial.print(stateName(floatDetector.getState()));
+        Serial.print(", fixed ");
+        Serial.println(stateName(fixedDetector.getState()));
+      }
+      mismatches++;
+    }
+
+    float error = fabsf(floatDetector.getNormalized() - fixedDetector.getNormalized().toFloat());
+    if (error > maxNormalizedError) maxNormalizedError = error;
+  }
+
+  Serial.println("");
+  Serial.print("Fixed-point check: ");
+  Serial.print((int)samples);
+  Serial.print(" samples, ");
+  Serial.print((int)transitions);
+  Serial.print(" transitions, ");
+  Serial.print((int)mismatches);
+  Serial.println(" mismatches");
+  Serial.print("Max normalized difference: ");
+  Serial.println(maxNormalizedError, 6);
+
+  return mismatches == 0 ? 0 : 1;
+}
+
+// Pixel values the benchmarks draw with
+struct BenchColors {
+  Palette palette;
+  Pixel sky[SCREEN_HEIGHT];
+  Pixel black, white, gray, yellow, cyan, blue, magenta, green;
+};
+
+static constexpr BenchColors makeBenchColors() {
+  BenchColors colors = {};
+  for (int y = 0; y < SCREEN_HEIGHT; y++) {
+    colors.sky[y] = colors.palette.pixel(Display::rgb565(y, y, y + 64));
+  }
+  colors.black = colors.palette.pixel(ST77XX_BLACK);
+  colors.white = colors.palette.pixel(ST77XX_WHITE);
+  colors.gray = colors.palette.pixel(ST77XX_GRAY);
+  colors.yellow = colors.palette.pixel(ST77XX_YELLOW);
+  colors.cyan = colors.palette.pixel(ST77XX_CYAN);
+  colors.blue = colors.palette.pixel(ST77XX_BLUE);
+  colors.magenta = colors.palette.pixel(ST77XX_MAGENTA);
+  colors.green = colors.palette.pixel(ST77XX_GREEN);
+  return colors;
+}
+
+static constexpr BenchColors benchColors = makeBenchColors();
+static_assert(!benchColors.palette.overflow, "Benchmark colors use more than PALETTE_SIZE colors");
+
+// Bulk fills of one live-mode frame (sky rows, foam and water columns)
+// and one diagnostic frame (clear, bar lines and fill), through either
+// the canvas or Raster. The wave moves each frame.
+static void drawBenchFrameGfx(Canvas& canvas, int frame) {
+  for (int y = 0; y < SCREEN_HEIGHT; y++) {
+    canvas.drawFastHLine(0, y, SCREEN_WIDTH, benchColors.sky[y]);
+  }
+  for (int x = 0; x < SCREEN_WIDTH; x++) {
+    int waveY = 40 + (x * 7 + frame) % 48;
+    int foamHeight = 2 + (x + frame) % 5;
+    canvas.drawFastVLine(x, waveY - foamHeight, foamHeight, benchColors.cyan);
+    canvas.drawFastVLine(x, waveY, SCREEN_HEIGHT - waveY, benchColors.blue);
+  }
+
+  int barWidth = frame % 54;
+  canvas.fillScreen(benchColors.black);
+  canvas.drawFastHLine(10, 54, SCREEN_WIDTH - 20, benchColors.gray);
+  canvas.drawFastVLine(64, 49, 10, benchColors.white);
+  canvas.fillRect(64 - barWidth, 51, barWidth, 6, benchColors.magenta);
+}
+
+static void drawBenchFrameRaster(FrameCanvas& canvas, int frame) {
+  Raster raster(canvas);
+  for (int y = 0; y < SCREEN_HEIGHT; y++) {
+    raster.fillRow(y, 0, SCREEN_WIDTH, benchColors.sky[y]);
+  }
+  for (int x = 0; x < SCREEN_WIDTH; x++) {
+    int waveY = 40 + (x * 7 + frame) % 48;
+    int foamHeight = 2 + (x + frame) % 5;
+    raster.fillColumn(x, waveY - foamHeight, waveY, benchColors.cyan);
+    raster.fillColumn(x, waveY, SCREEN_HEIGHT, benchColors.blue);
+  }
+
+  int barWidth = frame % 54;
+  raster.fill(benchColors.black);
+  raster.fillRow(54, 10, SCREEN_WIDTH - 10, benchColors.gray);
+  raster.fillColumn(64, 49, 59, benchColors.white);
+  raster.fillRect(64 - barWidth, 51, barWidth, 6, benchColors.magenta);
+}
+
+// Wall-clock microseconds per frame for one draw path
+template <typename CanvasType>
+static double timeBenchFrames(CanvasType& canvas, void (*draw)(CanvasType&, int), int frames) {
+  auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < frames; frame++) {
+    draw(canvas, frame);
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return seconds * 1e6 / frames;
+}
+
+// The same frames drawn through the canvas and through a direct path
+// into a one-strip-per-frame FrameCanvas: the first checkFrames are
+// compared pixel for pixel, then benchFrames of each are timed. Prints
+// the timings and returns the number of mismatched frames.
+static int compareDrawPaths(const char* gfxLabel, void (*drawGfx)(Canvas&, int),
+                            const char* directLabel, void (*drawDirect)(FrameCanvas&, int),
+                            int checkFrames, int benchFrames) {
+  Canvas gfxCanvas(SCREEN_WIDTH, SCREEN_HEIGHT);
+  FrameCanvas directCanvas(SCREEN_HEIGHT);
+
+  int mismatchedFrames = 0;
+  for (int frame = 0; frame < checkFrames; frame++) {
+    drawGfx(gfxCanvas, frame);
+    drawDirect(directCanvas, frame);
+    if (memcmp(gfxCanvas.getBuffer(), directCanvas.getBuffer(),
+               SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(Pixel)) != 0) {
+      mismatchedFrames++;
+    }
+  }
+
+  double gfxMicros = timeBenchFrames(gfxCanvas, drawGfx, benchFrames);
+  double directMicros = timeBenchFrames(directCanvas, drawDirect, benchFrames);
+
+  Serial.print(gfxLabel);
+  Serial.print((float)gfxMicros, 2);
+  Serial.println(" us/frame");
+  Serial.print(directLabel);
+  Serial.print((float)directMicros, 2);
+  Serial.print(" us/frame (");
+  Serial.print((float)(directMicros > 0 ? gfxMicros / directMicros : 0), 2);
+  Serial.println("x)");
+  Serial.print("Mismatched frames: ");
+  Serial.println(mismatchedFrames);
+  return mismatchedFrames;
+}
+
+int runRasterBenchmark() {
+  Serial.println("");
+  Serial.print("Raster benchmark: ");
+  Serial.print(RASTER_BENCH_FRAMES);
+  Serial.println(" frames per path");
+  int mismatchedFrames = compareDrawPaths("Adafruit_GFX: ", drawBenchFrameGfx,
+                                          "Raster:       ", drawBenchFrameRaster,
+                                          64, RASTER_BENCH_FRAMES);
+  return mismatchedFrames == 0 ? 0 : 1;
+}
+
+// Diagnostic-mode HUD text for one frame through the canvas or HudText
+// (same calls on both, so the drawing code is shared)
+template <typename Text>
+static void drawBenchText(Text& text, int frame) {
+  float delta = (frame % 2001 - 1000) * 0.0371f;
+  text.setCursor(10, 5);
+  text.setTextColor(benchColors.yellow);
+  text.setTextSize(1);
+  text.println("DIAGNOSTIC MODE");
+  text.setCursor(10, 22);
+  text.setTextColor(benchColors.white);
+  text.print("Delta: ");
+  text.setTextColor(delta >= 0 ? benchColors.cyan : benchColors.magenta);
+  text.print(delta, 2);
+  text.print(" Pa");
+  text.setCursor(10, 36);
+  text.print("Norm: ");
+  text.print(delta / 40.0f, 2);
+  text.setCursor(80, 36);
+  text.print(12.0f + (frame % 100) * 0.1f, 1);
+  text.print("bpm");
+  text.setCursor(10, 80);
+  text.setTextSize(2);
+  text.setTextColor(benchColors.green, benchColors.black);
+  text.print(29.92f + delta * 0.0003f, 3);
+  text.setTextSize(1);
+  text.print(" inHg");
+  text.setCursor(10, 114);
+  text.setTextColor(benchColors.gray);
+  text.print("Min:");
+  text.print(-20.0f - frame % 30, 0);
+  text.print(" Max:");
+  text.print(frame % 1000);
+}
+
+static void drawBenchTextGfx(Canvas& canvas, int frame) {
+  canvas.fillScreen(benchColors.black);
+  drawBenchText(canvas, frame);
+}
+
+static void drawBenchTextHud(FrameCanvas& canvas, int frame) {
+  Raster(canvas).fill(benchColors.black);
+  HudText text(canvas);
+  drawBenchText(text, frame);
+}
+
+// True when two formatted numbers differ by at most one unit in the last digit
+static bool differsInLastDigitOnly(const char* a, const char* b) {
+  double lastPlace = 1;
+  const char* point = strchr(a, '.');
+  if (point) {
+    for (const char* p = point + 1; *p; p++) lastPlace /= 10;
+  }
+  return strlen(a) <= strlen(b) + 1 && strlen(b) <= strlen(a) + 1 &&
+         fabs(atof(a) - atof(b)) <= lastPlace * 1.001;
+}
+
+int runTextBenchmark() {
+  glyphAtlas.init();
+
+  // The formatter against printf: identical, or one unit off in the last
+  // digit when the value is within float precision of a rounding tie
+  int formatMismatches = 0;
+  int roundingDifferences = 0;
+  srand(1);
+  for (int i = 0; i < TEXT_CHECK_VALUES; i++) {
+    float value = ((float)rand() / RAND_MAX - 0.5f) * powf(10.0f, (float)(i % 7));
+    int digits = i % 4;
+    char expected[32];
+    char actual[NUMBER_TEXT_SIZE];
+    snprintf(expected, sizeof(expected), "%.*f", digits, value);
+    formatFloat(actual, value, digits);
+    if (!strcmp(expected, actual)) continue;
+    if (differsInLastDigitOnly(expected, actual)) {
+      roundingDifferences++;
+    } else {
+      if (formatMismatches < MAX_REPORTED_MISMATCHES) {
+        Serial.print("Format mismatch: printf ");
+        Serial.print(expected);
+        Serial.print(", formatFloat ");
+        Serial.println(actual);
+      }
+      formatMismatches++;
+    }
+  }
+
+  // Atlas text against the canvas font
+  Serial.println("");
+  Serial.print("Text benchmark: ");
+  Serial.print(TEXT_BENCH_FRAMES);
+  Serial.println(" diagnostic HUD frames per path");
+  int mismatchedFrames = compareDrawPaths("Adafruit_GFX print: ", drawBenchTextGfx,
+                                          "HudText:            ", drawBenchTextHud,
+                                          256, TEXT_BENCH_FRAMES);
+  Serial.print("Formatted values: ");
+  Serial.print(TEXT_CHECK_VALUES);
+  Serial.print(", last-digit rounding differences: ");
+  Serial.print(roundingDifferences);
+  Serial.print(", mismatches: ");
+  Serial.println(formatMismatches);
+
+  return mismatchedFrames == 0 && formatMismatches == 0 ? 0 : 1;
+}
+
+// FNV-1a over a screen of pixels, low byte first
+template <typename PixelType>
+static uint64_t hashPixels(const PixelType* pixels) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
+    for (size_t byte = 0; byte < sizeof(PixelType); byte++) {
+      hash = (hash ^ ((pixels[i] >> (8 * byte)) & 0xFF)) * 1099511628211ULL;
+    }
+  }
+  return hash;
+}
+
+// The panel's RGB565 pixels
+static uint64_t hashPanel(const uint16_t* panel) {
+  return hashPixels(panel);
+}
+
+// The canvas font's printable ASCII glyphs. Goldens store it, so frames
+// recorded against another Adafruit GFX font are reported as such rather
+// than as a wall of mismatches.
+static uint64_t hashFont() {
+  Canvas canvas(SCREEN_WIDTH, SCREEN_HEIGHT);
+  for (int c = ' '; c <= '~'; c++) {
+    int i = c - ' ';
+    canvas.drawChar((i % 21) * 6, (i / 21) * 8, c, 1, 0, 1, 1);
+  }
+  return hashPixels(canvas.getBuffer());
+}
+
+// Panel image as a binary PPM, RGB565 widened to 8 bits per channel
+static bool writePpm(const char* path, const uint16_t* panel) {
+  FILE* file = fopen(path, "wb");
+  if (!file) {
+    Serial.print("Cannot write ");
+    Serial.println(path);
+    return false;
+  }
+  fprintf(file, "P6\n%d %d\n255\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+  for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
+    uint8_t rgb[3] = {
+      (uint8_t)(((panel[i] >> 11) & 0x1F) * 255 / 31),
+      (uint8_t)(((panel[i] >> 5) & 0x3F) * 255 / 63),
+      (uint8_t)((panel[i] & 0x1F) * 255 / 31)
+    };
+    fwrite(rgb, 1, sizeof(rgb), file);
+  }
+  fclose(file);
+  return true;
+}
+
+// Golden file lines: "font hash" (see hashFont(), 0 when missing), then
+// "mode frame hash" (hashes in hex); '#' starts a comment. Frames missing
+// from the file read as hash 0.
+static bool loadGoldenHashes(const char* path, uint64_t& font, std::vector<uint64_t> hashes[]) {
+  FILE* file = fopen(path, "r");
+  if (!file) return false;
+
+  font = 0;
+  char line[128];
+  while (fgets(line, sizeof(line), file)) {
+    char name[32];
+    int frame;
+    unsigned long long hash;
+    if (line[0] == '#') continue;
+    if (sscanf(line, "font %llx", &hash) == 1) {
+      font = hash;
+      continue;
+    }
+    if (sscanf(line, "%31s %d %llx", name, &frame, &hash) != 3) continue;
+    for (int m = 0; m < SCRIPTED_MODE_COUNT; m++) {
+      if (strcmp(name, scriptedModes[m].name) || frame < 0) continue;
+      if ((size_t)frame >= hashes[m].size()) hashes[m].resize(frame + 1, 0);
+      hashes[m][frame] = hash;
+    }
+  }
+  fclose(file);
+  return true;
+}
+
+static bool writeGoldenHashes(const char* path, uint64_t font, const std::vector<uint64_t> hashes[]) {
+  FILE* file = fopen(path, "w");
+  if (!file) {
+    Serial.print("Cannot write ");
+    Serial.println(path);
+    return false;
+  }
+  fprintf(file, "# Render goldens: mode frame FNV-1a of the RGB565 panel (--update-golden)\n");
+  fprintf(file, "font %016llx\n", (unsigned long long)font);
+  for (int m = 0; m < SCRIPTED_MODE_COUNT; m++) {
+    for (size_t frame = 0; frame < hashes[m].size(); frame++) {
+      fprintf(file, "%s %d %016llx\n", scriptedModes[m].name, (int)frame,
+              (unsigned long long)hashes[m][frame]);
+    }
+  }
+  fclose(file);
+  return true;
+}
+
+// Wall-clock time of RENDER_BENCH_FRAMES frames per mode, including the
+// strip diff and the copy into the panel image
+static void runRenderBenchmark() {
+  double totalSeconds = 0;
+  Serial.println("");
+  Serial.print("Render benchmark: ");
+  Serial.print(RENDER_BENCH_FRAMES);
+  Serial.println(" scripted frames per mode");
+
+  for (int m = 0; m < SCRIPTED_MODE_COUNT; m++) {
+    const ScriptedMode& mode = scriptedModes[m];
+    BlitStats before = display.getBlitStats();
+
+    auto start = std::chrono::steady_clock::now();
+    drawScriptedFrames(mode, 0, RENDER_BENCH_FRAMES);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    totalSeconds += seconds;
+
+    const BlitStats& after = display.getBlitStats();
+    uint64_t fullBytes = after.fullFrameBytes - before.fullFrameBytes;
+    uint64_t sentBytes = after.sentBytes - before.sentBytes;
+
+    Serial.print(mode.name);
+    Serial.print(": ");
+    Serial.print((float)(RENDER_BENCH_FRAMES / seconds), 0);
+    Serial.print(" frames/s, ");
+    Serial.print((float)(seconds * 1e9 / RENDER_BENCH_FRAMES), 0);
+    Serial.print(" ns/frame, SPI ");
+    Serial.print(fullBytes > 0 ? 100.0f * sentBytes / fullBytes : 0.0f, 1);
+    Serial.println("% of full frames");
+  }
+
+  int totalFrames = RENDER_BENCH_FRAMES * SCRIPTED_MODE_COUNT;
+  Serial.print("All modes: ");
+  Serial.print((float)(totalFrames / totalSeconds), 0);
+  Serial.print(" frames/s, ");
+  Serial.print((float)(totalSeconds * 1e9 / totalFrames), 0);
+  Serial.println(" ns/frame");
+}
+
+int runRenderCheck(const SimulatorOptions& options) {
+  display.init();
+  glyphAtlas.init();
+  latencyTrace.reset();
+
+  char path[512];
+  bool compare = options.goldenDir && !options.updateGolden;
+  uint64_t font = hashFont();
+  uint64_t expectedFont = 0;
+  std::vector<uint64_t> expected[SCRIPTED_MODE_COUNT];
+  std::vector<uint64_t> actual[SCRIPTED_MODE_COUNT];
+
+  if (options.goldenDir) {
+    snprintf(path, sizeof(path), "%s/frames.txt", options.goldenDir);
+    if (options.updateGolden) {
+      mkdir(options.goldenDir, 0755);
+    } else if (!loadGoldenHashes(path, expectedFont, expected)) {
+      Serial.print("No golden hashes in ");
+      Serial.print(path);
+      Serial.println(" (record them with --update-golden)");
+      return 1;
+    } else if (expectedFont != 0 && expectedFont != font) {
+      char fonts[64];
+      snprintf(fonts, sizeof(fonts), "%016llx, this build %016llx",
+               (unsigned long long)expectedFont, (unsigned long long)font);
+      Serial.print("Golden frames were recorded with another canvas font: ");
+      Serial.println(fonts);
+      Serial.println("Build against the Adafruit GFX version in platformio.ini, or re-record with --update-golden");
+      return 1;
+    }
+  }
+  if (options.dumpDir) mkdir(options.dumpDir, 0755);
+
+  // Every mode's script from a fresh start, so live mode's animation
+  // state is the same on every run
+  int checked = 0;
+  int mismatches = 0;
+  for (int m = 0; m < SCRIPTED_MODE_COUNT; m++) {
+    const ScriptedMode& mode = scriptedModes[m];
+    int scriptFrames = scriptFrameCount(mode);
+    for (int frame = 0; frame < scriptFrames; frame++) {
+      drawScriptedFrames(mode, frame, 1);
+      const uint16_t* panel = display.getPanel();
+      uint64_t hash = hashPanel(panel);
+      actual[m].push_back(hash);
+
+      if (options.dumpDir) {
+        snprintf(path, sizeof(path), "%s/%s-%04d.ppm", options.dumpDir, mode.name, frame);
+        if (!writePpm(path, panel)) return 1;
+      }
+
+      if (!compare) continue;
+      checked++;
+      if ((size_t)frame < expected[m].size() && expected[m][frame] == hash) continue;
+
+      // Keep the first few differing frames next to the goldens for viewing
+      if (mismatches < MAX_REPORTED_MISMATCHES) {
+        snprintf(path, sizeof(path), "%s/%s-%04d.actual.ppm", options.goldenDir, mode.name, frame);
+        Serial.print("Mismatch: ");
+        Serial.print(mode.name);
+        Serial.print(" frame ");
+        Serial.print(frame);
+        Serial.print(", wrote ");
+        Serial.println(path);
+        writePpm(path, panel);
+      }
+      mismatches++;
+    }
+
+    // Golden frames the script no longer draws
+    if (compare && expected[m].size() > (size_t)scriptFrames) {
+      mismatches += expected[m].size() - scriptFrames;
+    }
+  }
+
+  if (options.updateGolden) {
+    snprintf(path, sizeof(path), "%s/frames.txt", options.goldenDir);
+    if (!writeGoldenHashes(path, font, actual)) return 1;
+    Serial.print("Wrote golden hashes to ");
+    Serial.println(path);
+  }
+  if (compare) {
+    Serial.println("");
+    Serial.print("Golden frames: ");
+    Serial.print(checked);
+    Serial.print(" checked, ");
+    Serial.print(mismatches);
+    Serial.println(" mismatches");
+  }
+  if (options.benchRender) runRenderBenchmark();
+
+  return mismatches == 0 ? 0 : 1;
+}
+
+// Stored settings record layout (see SettingsStore): magic, version and
+// payload size, then the payload and its CRC-32
+static const size_t SETTINGS_HEADER_SIZE = 8;
+static const size_t SETTINGS_SIZE_OFFSET = 6;
+static const size_t SETTINGS_VERSION_OFFSET = 4;
+
+// Payload bytes the "newer firmware" record appends
+static const size_t SETTINGS_NEWER_BYTES = 4;
+
+// Rewrite the stored record with a different payload size (and version),
+// with a valid CRC, as another firmware version would have written it
+static void storeResizedRecord(const uint8_t* record, uint16_t version, uint16_t payloadSize) {
+  uint8_t resized[SETTINGS_HEADER_SIZE + sizeof(Settings) + SETTINGS_NEWER_BYTES + sizeof(uint32_t)] = {};
+  size_t copied = SETTINGS_HEADER_SIZE + (payloadSize < sizeof(Settings) ? payloadSize : sizeof(Settings));
+  memcpy(resized, record, copied);
+  memcpy(resized + SETTINGS_VERSION_OFFSET, &version, sizeof(version));
+  memcpy(resized + SETTINGS_SIZE_OFFSET, &payloadSize, sizeof(payloadSize));
+  size_t payloadEnd = SETTINGS_HEADER_SIZE + payloadSize;
+  uint32_t crc = crc32(resized, payloadEnd);
+  memcpy(resized + payloadEnd, &crc, sizeof(crc));
+  storage.writeSettings(resized, payloadEnd + sizeof(crc));
+}
+
+// Load the stored record with a fresh store and compare with what it
+// should give
+static bool checkSettingsLoad(const char* name, const Settings& expected) {
+  SettingsStore store;
+  const Settings& loaded = store.load();
+  bool match = memcmp(&loaded, &expected, sizeof(Settings)) == 0;
+  Serial.print("  ");
+  Serial.print(name);
+  Serial.println(match ? ": ok" : ": MISMATCH");
+  return match;
+}
+
+int runSettingsCheck() {
+  storage.init();
+
+  Settings stored = defaultSettings();
+  stored.inhaleThreshold = -7.5f;
+  stored.exhaleThreshold = 6.25f;
+  stored.sensorProfile = SENSOR_PROFILE_LOW_NOISE;
+  stored.mode = MODE_DIAGNOSTIC;
+  stored.minDelta = -31.0f;
+  stored.maxDelta = 27.0f;
+
+  SettingsStore writer;
+  writer.load();
+  writer.update(stored);
+  writer.flush();
+
+  uint8_t record[SETTINGS_HEADER_SIZE + sizeof(Settings) + sizeof(uint32_t)];
+  if (storage.readSettings(record, sizeof(record)) != sizeof(record)) {
+    Serial.println("Settings check: no record written");
+    return 1;
+  }
+
+  Serial.println("");
+  Serial.println("Settings check:");
+  int failures = 0;
+
+  // The record as written
+  if (!checkSettingsLoad("stored record", stored)) failures++;
+
+  // A bad CRC: ignored, defaults apply
+  uint8_t corrupted[sizeof(record)];
+  memcpy(corrupted, record, sizeof(record));
+  corrupted[sizeof(record) - 1] ^= 0x01;
+  storage.writeSettings(corrupted, sizeof(corrupted));
+  if (!checkSettingsLoad("corrupted CRC", defaultSettings())) failures++;
+
+  // An older version's payload, written before the bounds were stored:
+  // its fields load, the bounds keep their defaults
+  Settings older = stored;
+  older.minDelta = DEFAULT_MIN_DELTA;
+  older.maxDelta = DEFAULT_MAX_DELTA;
+  storeResizedRecord(record, SETTINGS_VERSION, offsetof(Settings, minDelta));
+  if (!checkSettingsLoad("shorter payload", older)) failures++;
+
+  // A newer version's payload: the fields this version knows load
+  storeResizedRecord(record, SETTINGS_VERSION + 1, sizeof(Settings) + SETTINGS_NEWER_BYTES);
+  if (!checkSettingsLoad("longer payload", stored)) failures++;
+
+  // Valid records with bounds the detector cannot use (a reciprocal
+  // beyond Q16, a bound beyond its range): the bounds fall back to defaults
+  const float unusableBounds[][2] = { { -1e-30f, 27.0f }, { -40000.0f, 27.0f }, { -31.0f, 0.0f } };
+  for (const auto& bounds : unusableBounds) {
+    Settings unusable = stored;
+    unusable.minDelta = bounds[0];
+    unusable.maxDelta = bounds[1];
+    writer.update(unusable);
+    writer.flush();
+    if (!checkSettingsLoad("unusable bounds", older)) failures++;
+  }
+
+  Serial.print("Settings check: ");
+  Serial.print(failures);
+  Serial.println(" failures");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,38 @@
+#ifndef HARNESS_H
+#define HARNESS_H
+
+// Headless self-checks run instead of the normal setup()/loop() session
+
+#include "Options.h"
+
+// Feed every sensor sample through BreathDetector<float> and
+// BreathDetector<Q16> and compare their state sequences.
+// Returns the process exit code (0 when both agree).
+int runFixedPointCheck(const SimulatorOptions& options);
+
+// Time the live/diagnostic bulk fills through Adafruit_GFX and through
+// Raster, and check that both draw the same pixels.
+// Returns the process exit code (0 when the frames match).
+int runRasterBenchmark();
+
+// Time diagnostic HUD text through the canvas font and through HudText,
+// check that both draw the same pixels and that formatFloat() matches
+// printf. Returns the process exit code (0 when everything matches).
+int runTextBenchmark();
+
+// Drive the live and diagnostic modes with scripted breath input and a
+// fixed frame interval from a fresh start, so every run draws the same
+// frames. Hashes each panel image and compares it with (or writes) the
+// golden hashes, dumps frames as PPM images and times the frames per mode,
+// as selected by the options. Returns the process exit code (0 when every
+// frame matches its golden hash).
+int runRenderCheck(const SimulatorOptions& options);
+
+// Load settings records as written by this and other firmware versions:
+// the stored record, one with a bad CRC (defaults), an older shorter
+// payload (missing fields keep their defaults), a newer longer one and
+// valid records with bounds the detector cannot use (defaults).
+// Returns the process exit code (0 when each loads as intended).
+int runSettingsCheck();
+
+#endif // HARNESS_H
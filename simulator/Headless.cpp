@@ -0,0 +1,130 @@
+// Headless simulator entry point
+// Runs setup()/loop() against a virtual clock with no SDL window, so hours
+// of breathing can be simulated in seconds.
+#include <chrono>
+#include "Platform.h"
+#include "config.h"
+#include "BreathData.h"
+#include "BreathTrace.h"
+#include "Display.h"
+#include "Harness.h"
+#include "LatencyTrace.h"
+#include "Options.h"
+#include "Sampler.h"
+#include "Scheduler.h"
+#include "Sensor.h"
+#include "SessionLog.h"
+#include "Settings.h"
+
+extern AppMode currentMode;
+void setup();
+void loop();
+
+// Simulated time between mode switches with --mode both
+static const uint32_t MODE_SWITCH_MS = 10000;
+
+int main(int argc, char* argv[]) {
+  SimulatorOptions options;
+  if (!parseSimulatorArgs(argc, argv, options)) return 1;
+
+  // There is no mouse: default to synthetic breathing
+  if (!options.traceSource) {
+    pressureSensor.useSyntheticBreath(SyntheticBreathParams());
+  }
+
+  if (options.checkFixedPoint) return runFixedPointCheck(options);
+  if (options.benchRaster) return runRasterBenchmark();
+  if (options.benchText) return runTextBenchmark();
+  if (options.checkSettings) return runSettingsCheck();
+  if (options.goldenDir || options.dumpDir || options.benchRender) {
+    return runRenderCheck(options);
+  }
+
+  setup();
+
+  // The command line overrides the stored mode
+  bool alternate = !strcmp(options.mode, "both");
+  currentMode = !strcmp(options.mode, "diagnostic") ? MODE_DIAGNOSTIC : MODE_LIVE;
+
+  auto wallStart = std::chrono::steady_clock::now();
+  uint32_t simStart = millis();
+  uint32_t lastModeSwitch = simStart;
+
+  // Advance the virtual clock 1 ms at a time, running the sampler and
+  // the scheduled tasks whenever they come due
+  while (millis() - simStart < options.durationMs) {
+    sampler.poll();
+    loop();
+
+    uint32_t now = millis();
+
+    if (alternate && now - lastModeSwitch >= MODE_SWITCH_MS) {
+      lastModeSwitch = now;
+      currentMode = (currentMode == MODE_LIVE) ? MODE_DIAGNOSTIC : MODE_LIVE;
+    }
+
+    if (pressureSensor.isTraceFinished() && sampler.available() == 0) break;
+
+    delay(1);
+  }
+
+  double wallSeconds = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - wallStart).count();
+  double simSeconds = (millis() - simStart) / 1000.0;
+
+  Serial.println("");
+  Serial.print("Simulated ");
+  Serial.print((float)simSeconds, 1);
+  Serial.print(" s in ");
+  Serial.print((float)wallSeconds, 3);
+  Serial.print(" s (");
+  Serial.print((float)(wallSeconds > 0 ? simSeconds / wallSeconds : 0), 0);
+  Serial.println("x real time)");
+
+  Serial.print("Samples: ");
+  Serial.print((int)sampler.getSampleCount());
+  Serial.print("  Dropped: ");
+  Serial.println((int)sampler.getDroppedCount());
+
+  Serial.print("Breaths: ");
+  Serial.print(breathData.getBreathCount());
+  Serial.print("  Rate: ");
+  Serial.print(breathData.getBreathRate(), 1);
+  Serial.print(" bpm (confidence ");
+  Serial.print(breathData.getBreathRateConfidence(), 2);
+  Serial.println(")");
+  const BlitStats& blit = display.getBlitStats();
+  Serial.print("Frames: ");
+  Serial.print((int)blit.frames);
+  Serial.print("  SPI: ");
+  Serial.print(blit.sentBytes / 1e6f, 2);
+  Serial.print(" MB of ");
+  Serial.print(blit.fullFrameBytes / 1e6f, 2);
+  Serial.print(" MB full-frame (");
+  Serial.print(blit.fullFrameBytes > 0 ? 100.0f * blit.sentBytes / blit.fullFrameBytes : 0.0f, 1);
+  Serial.println("%)");
+
+  reportSessionStats(breathData.getSessionStats());
+  latencyTrace.report();
+  detectScheduler.report();
+  scheduler.report();
+
+  const BreathLog& log = breathData.getBreathLog();
+  Serial.print("Breath log: ");
+  Serial.print((int)log.size());
+  Serial.print(" of ");
+  Serial.print((int)log.capacity());
+  Serial.print(" records (");
+  Serial.print((int)log.memoryBytes());
+  Serial.println(" bytes)");
+
+  // End the running session as an idle device would, and store it
+  SessionSummary summary;
+  if (breathData.finishSession(summary)) sessionLog.enqueue(summary);
+  sessionLog.flush();
+  settingsStore.flush();
+  storageScheduler.report();
+  sessionLog.report();
+  settingsStore.report();
+  return 0;
+}
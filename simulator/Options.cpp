@@ -0,0 +1,144 @@
+// Simulator command line parsing
+#include "Options.h"
+#include "BreathTrace.h"
+#include "Sensor.h"
+#include "Storage.h"
+#include "config.h"
+
+extern SerialMock Serial;
+
+static void printUsage() {
+  Serial.println("Usage: program [options]");
+  Serial.println("  --replay FILE       Replay a recorded trace (timestamp_ms,pressure_pa,temperature_c)");
+  Serial.println("  --loop              Loop the replayed trace");
+  Serial.println("  --synthetic [SPEC]  Synthetic breathing, e.g. rate=12,depth=30,hold-in=2000,");
+  Serial.println("                      hold-out=0,inhale=0.4,drift=0,noise=0.5,lead-in=1500,hz=100,seed=1");
+  Serial.println("  --record FILE       Record every sensor reading to a trace");
+  Serial.println("  --fast              Feed trace samples as fast as they are consumed");
+  Serial.println("  --storage FILE      Keep the session log and settings in FILE across runs");
+  Serial.println("  --storage-latency SPEC  Stall flash operations, e.g. write=5,erase=45 (ms)");
+  Serial.println("Headless only:");
+  Serial.println("  --duration TIME     Simulated time to run, e.g. 90s, 30m, 2h (default 60s)");
+  Serial.println("  --mode MODE         live, diagnostic or both (alternate every 10s)");
+  Serial.println("  --check-fixed       Compare float and fixed-point breath detection on the trace");
+  Serial.println("  --bench-raster      Time Adafruit_GFX versus Raster bulk fills");
+  Serial.println("  --bench-text        Time Adafruit_GFX versus HudText HUD text");
+  Serial.println("  --golden DIR        Render scripted frames of every mode and compare their");
+  Serial.println("                      hashes with DIR/frames.txt");
+  Serial.println("  --update-golden     With --golden: rewrite DIR/frames.txt from this build");
+  Serial.println("  --dump-frames DIR   Write every scripted frame to DIR as a PPM image");
+  Serial.println("  --bench-render      Time the scripted frames: frames/s and ns/frame per mode");
+  Serial.println("  --check-settings    Load stored, corrupted, older and newer settings records");
+}
+
+// "90", "90s", "30m", "2h" -> milliseconds
+static bool parseDuration(const char* text, uint32_t& ms) {
+  char* end = nullptr;
+  double value = strtod(text, &end);
+  if (end == text || value <= 0) return false;
+
+  double scale = 1000.0;
+  if (*end == 'm') scale = 60000.0;
+  else if (*end == 'h') scale = 3600000.0;
+  else if (*end != 's' && *end != '\0') return false;
+
+  ms = (uint32_t)(value * scale);
+  return true;
+}
+
+// "write=5,erase=45" -> per-operation flash latency (ms)
+static bool parseStorageLatency(const char* spec, uint32_t& writeMs, uint32_t& eraseMs) {
+  while (*spec) {
+    char* end = nullptr;
+    if (!strncmp(spec, "write=", 6)) {
+      writeMs = strtoul(spec + 6, &end, 10);
+    } else if (!strncmp(spec, "erase=", 6)) {
+      eraseMs = strtoul(spec + 6, &end, 10);
+    } else {
+      return false;
+    }
+    if (end == spec + 6 || (*end != ',' && *end != '\0')) return false;
+    spec = *end ? end + 1 : end;
+  }
+  return true;
+}
+
+bool parseSimulatorArgs(int argc, char* argv[], SimulatorOptions& options) {
+  bool loop = false;
+  const char* replayPath = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    bool hasValue = i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0;
+
+    if (!strcmp(arg, "--replay") && hasValue) {
+      replayPath = argv[++i];
+    } else if (!strcmp(arg, "--loop")) {
+      loop = true;
+    } else if (!strcmp(arg, "--synthetic")) {
+      SyntheticBreathParams params;
+      if (!parseSyntheticParams(hasValue ? argv[++i] : "", params)) {
+        Serial.println("Invalid --synthetic parameters");
+        return false;
+      }
+      pressureSensor.useSyntheticBreath(params);
+      options.traceSource = true;
+    } else if (!strcmp(arg, "--record") && hasValue) {
+      if (!pressureSensor.recordTrace(argv[++i])) return false;
+    } else if (!strcmp(arg, "--fast")) {
+      pressureSensor.setFreeRunning(true);
+    } else if (!strcmp(arg, "--storage") && hasValue) {
+      storage.useFile(argv[++i]);
+    } else if (!strcmp(arg, "--storage-latency") && hasValue) {
+      uint32_t writeMs = 0;
+      uint32_t eraseMs = 0;
+      if (!parseStorageLatency(argv[++i], writeMs, eraseMs)) {
+        Serial.println("Invalid --storage-latency");
+        return false;
+      }
+      storage.setLatency(writeMs, eraseMs);
+    } else if (!strcmp(arg, "--duration") && hasValue) {
+      if (!parseDuration(argv[++i], options.durationMs)) {
+        Serial.println("Invalid --duration");
+        return false;
+      }
+    } else if (!strcmp(arg, "--mode") && hasValue) {
+      options.mode = argv[++i];
+      if (strcmp(options.mode, "live") && strcmp(options.mode, "diagnostic") &&
+          strcmp(options.mode, "both")) {
+        printUsage();
+        return false;
+      }
+    } else if (!strcmp(arg, "--check-fixed")) {
+      options.checkFixedPoint = true;
+    } else if (!strcmp(arg, "--bench-raster")) {
+      options.benchRaster = true;
+    } else if (!strcmp(arg, "--bench-text")) {
+      options.benchText = true;
+    } else if (!strcmp(arg, "--golden") && hasValue) {
+      options.goldenDir = argv[++i];
+    } else if (!strcmp(arg, "--update-golden")) {
+      options.updateGolden = true;
+    } else if (!strcmp(arg, "--dump-frames") && hasValue) {
+      options.dumpDir = argv[++i];
+    } else if (!strcmp(arg, "--bench-render")) {
+      options.benchRender = true;
+    } else if (!strcmp(arg, "--check-settings")) {
+      options.checkSettings = true;
+    } else {
+      printUsage();
+      return false;
+    }
+  }
+
+  if (options.updateGolden && !options.goldenDir) {
+    Serial.println("--update-golden needs --golden DIR");
+    return false;
+  }
+
+  if (replayPath) {
+    if (!pressureSensor.replayTrace(replayPath, loop)) return false;
+    options.traceSource = true;
+  }
+  return true;
+}
@@ -0,0 +1,26 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+// Simulator command line options (SDL and headless builds)
+
+#include <cstdint>
+
+struct SimulatorOptions {
+  bool traceSource = false;         // --replay or --synthetic given
+  uint32_t durationMs = 60000;      // Headless: simulated time to run
+  const char* mode = "live";        // Headless: live, diagnostic or both
+  bool checkFixedPoint = false;     // Headless: compare float and Q16 detection
+  bool benchRaster = false;         // Headless: time GFX versus Raster fills
+  bool benchText = false;           // Headless: time GFX versus HudText text
+  const char* goldenDir = nullptr;  // Headless: compare rendered frames with DIR/frames.txt
+  bool updateGolden = false;        // Headless: rewrite the golden hashes instead
+  const char* dumpDir = nullptr;    // Headless: write every scripted frame as a PPM
+  bool benchRender = false;         // Headless: time every mode's frames
+  bool checkSettings = false;       // Headless: load settings records of every version
+};
+
+// Parse the command line and configure the simulated sensor.
+// Prints usage and returns false on unknown or invalid options.
+bool parseSimulatorArgs(int argc, char* argv[], SimulatorOptions& options);
+
+#endif // OPTIONS_H
@@ -8,7 +8,11 @@
 #include <cstring>
 #include <algorithm>
 #include <iostream>
-#include <SDL2/SDL.h>
+#ifdef HEADLESS
+  #include <atomic>
+#else
+  #include <SDL2/SDL.h>
+#endif
 
 // Arduino types
 using uint8_t = std::uint8_t;
@@ -19,13 +23,40 @@ using int16_t = std::int16_t;
 using int32_t = std::int32_t;
 
 // Arduino timing
+#ifdef HEADLESS
+// Virtual clock: time only moves when the harness advances it (or code
+// calls delay()), so hours of session time run at full CPU speed
+inline std::atomic<uint64_t> virtualClockMicros{0};
+
+inline void advanceClockMicros(uint64_t us) {
+  virtualClockMicros.fetch_add(us);
+}
+
+inline uint32_t millis() {
+  return (uint32_t)(virtualClockMicros.load() / 1000);
+}
+
+inline uint32_t micros() {
+  return (uint32_t)virtualClockMicros.load();
+}
+
+inline void delay(uint32_t ms) {
+  advanceClockMicros((uint64_t)ms * 1000);
+}
+#else
 inline uint32_t millis() {
   return SDL_GetTicks();
 }
 
+inline uint32_t micros() {
+  static const uint64_t ticksPerMicro = SDL_GetPerformanceFrequency() / 1000000ULL;
+  return (uint32_t)(SDL_GetPerformanceCounter() / (ticksPerMicro ? ticksPerMicro : 1));
+}
+
 inline void delay(uint32_t ms) {
   SDL_Delay(ms);
 }
+#endif
 
 // Arduino math
 #ifndef TWO_PI
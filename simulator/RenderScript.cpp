@@ -0,0 +1,70 @@
+#include "RenderScript.h"
+#include "modes/live_mode.h"
+#include "modes/diagnostic_mode.h"
+
+// Breath cycles of this length, drawn for this long per pass
+static const float SCRIPT_CYCLE_SECONDS = 6.0f;
+static const int SCRIPT_SECONDS = 12;
+
+const ScriptedMode scriptedModes[] = {
+  { "live", MODE_LIVE, WAVE_UPDATE_FPS },
+  { "diagnostic", MODE_DIAGNOSTIC, DIAGNOSTIC_UPDATE_FPS },
+};
+const int SCRIPTED_MODE_COUNT = sizeof(scriptedModes) / sizeof(scriptedModes[0]);
+
+int scriptFrameCount(const ScriptedMode& mode) {
+  return SCRIPT_SECONDS * mode.fps;
+}
+
+static float smoothStep(float x) {
+  return x * x * (3.0f - 2.0f * x);
+}
+
+// Each cycle is a 2 s inhale, a 1 s hold, a 2 s exhale and a 1 s rest;
+// both peaks push past the calibration bounds. The rate turns confident
+// from the second cycle.
+BreathSnapshot scriptedBreath(float seconds) {
+  int cycle = (int)(seconds / SCRIPT_CYCLE_SECONDS);
+  float t = seconds - cycle * SCRIPT_CYCLE_SECONDS;
+
+  BreathSnapshot breath = {};
+  if (t < 2.0f) {
+    breath.state = BREATH_INHALE;
+    breath.normalized = -smoothStep(t / 2.0f);
+  } else if (t < 3.0f) {
+    breath.state = BREATH_HOLD;
+    breath.normalized = -1.0f;
+  } else if (t < 4.0f) {
+    breath.state = BREATH_EXHALE;
+    breath.normalized = 2.0f * smoothStep(t - 3.0f) - 1.0f;
+  } else if (t < 5.0f) {
+    breath.state = BREATH_EXHALE;
+    breath.normalized = 1.0f - smoothStep(t - 4.0f);
+  } else {
+    breath.state = BREATH_IDLE;
+  }
+
+  breath.breathCount = cycle;
+  breath.minDelta = -24.0f;
+  breath.maxDelta = 20.0f;
+  float bound = breath.normalized >= 0 ? breath.maxDelta : -breath.minDelta;
+  breath.pressureDelta = breath.normalized * bound * 1.3f;
+  breath.pressure = 101325.0f + breath.pressureDelta;
+  breath.temperature = 22.5f + 0.05f * seconds;
+  breath.rate = 10.0f + 0.5f * cycle;
+  breath.rateConfidence = cycle > 0 ? 0.9f : 0.2f;
+  breath.hasSample = true;
+  return breath;
+}
+
+void drawScriptedFrames(const ScriptedMode& mode, int first, int count) {
+  int scriptFrames = scriptFrameCount(mode);
+  for (int frame = first; frame < first + count; frame++) {
+    BreathSnapshot breath = scriptedBreath((float)(frame % scriptFrames) / mode.fps);
+    if (mode.mode == MODE_LIVE) {
+      drawLiveMode(breath, 1.0f / mode.fps);
+    } else {
+      drawDiagnosticMode(breath);
+    }
+  }
+}
@@ -0,0 +1,31 @@
+#ifndef RENDER_SCRIPT_H
+#define RENDER_SCRIPT_H
+
+// Scripted render input shared by the headless render check and the
+// microbenchmarks: a fixed breath cycle drawn at each mode's frame rate,
+// with no sensor or scheduler involved, so every run draws the same frames
+
+#include "BreathData.h"
+#include "config.h"
+
+// Modes the script drives, with their frame rates
+struct ScriptedMode {
+  const char* name;
+  AppMode mode;
+  int fps;
+};
+
+extern const ScriptedMode scriptedModes[];
+extern const int SCRIPTED_MODE_COUNT;
+
+// Frames in one pass of a mode's script
+int scriptFrameCount(const ScriptedMode& mode);
+
+// Breath input at a script time (seconds from the start)
+BreathSnapshot scriptedBreath(float seconds);
+
+// Draw frames first .. first + count - 1 of a mode's script, each one
+// frame interval after the last. Frame numbers wrap at the script length.
+void drawScriptedFrames(const ScriptedMode& mode, int first, int count);
+
+#endif // RENDER_SCRIPT_H
@@ -1,10 +1,59 @@
 // Simulator implementation of Sensor
+#include <atomic>
+#include "BreathTrace.h"
 #include "Sensor.h"
+#include "SensorProfile.h"
 #include "Display.h"
 #include "config.h"
+#include <cstdlib>
 
 extern SerialMock Serial;
 
+// RMS pressure noise of a single unfiltered x1 conversion (Pa)
+static const float SIM_NOISE_PA = 1.3f;
+
+// Approximately normal noise with unit variance (Irwin-Hall)
+static float gaussianNoise() {
+  float sum = 0;
+  for (int i = 0; i < 12; i++) {
+    sum += (float)rand() / RAND_MAX;
+  }
+  return sum - 6.0f;
+}
+
+// Where readings come from
+enum SensorSource {
+  SOURCE_MOUSE,
+  SOURCE_REPLAY,
+  SOURCE_SYNTHETIC
+};
+
+static SensorSource source = SOURCE_MOUSE;
+static TraceReplay replay;
+static SyntheticBreath synthetic;
+static TraceRecorder recorder;
+
+// Trace playback timeline (hasPending is also polled by the main thread)
+static std::atomic<bool> hasPending{false};
+static TracePoint pending;
+static unsigned long traceStartMillis = 0;
+static unsigned long traceFirstTimestamp = 0;
+
+// Next point from the active trace source
+static bool nextTracePoint(TracePoint& point) {
+  if (source == SOURCE_SYNTHETIC) {
+    point = synthetic.next();
+    return true;
+  }
+  return replay.next(point);
+}
+
+static void startTrace() {
+  hasPending = nextTracePoint(pending);
+  traceStartMillis = millis();
+  traceFirstTimestamp = hasPending ? pending.timestamp : 0;
+}
+
 void Sensor::init() {
   Serial.println("Initializing simulated sensor...");
   Serial.println("Use mouse Y position to simulate breath pressure");
@@ -20,29 +69,159 @@ void Sensor::init() {
 
 void Sensor::calibrateBaseline() {
   Serial.println("Calibrating baseline (simulated)...");
-  display.showMessage("Calibrating...\n  Move mouse\n  to center", ST77XX_CYAN);
-  SDL_Delay(1000);
+
+  if (source == SOURCE_MOUSE) {
+    display.showMessage("Calibrating...\n  Move mouse\n  to center", ST77XX_CYAN);
+    delay(1000);
+  } else {
+    // Traces carry absolute pressure: average 50 readings like the hardware
+    display.showMessage("Calibrating...\n  from trace", ST77XX_CYAN);
+    float sum = 0;
+    for (int i = 0; i < 50; i++) {
+      update();
+      sum += currentPressure;
+      if (!_freeRunning) delay(20);
+    }
+    baselinePressure = sum / 50.0f;
+    pressureDelta = currentPressure - baselinePressure;
+
+    Serial.print("Baseline pressure: ");
+    Serial.print(baselinePressure);
+    Serial.println(" Pa");
+  }
+
   display.clear();
   Serial.println("Baseline calibrated (simulated)");
 }
 
+bool Sensor::replayTrace(const char* path, bool loop) {
+  if (!replay.load(path)) {
+    Serial.print("Could not load trace: ");
+    Serial.println(path);
+    return false;
+  }
+  replay.setLoop(loop);
+  source = SOURCE_REPLAY;
+  startTrace();
+
+  Serial.print("Replaying trace: ");
+  Serial.print(path);
+  Serial.print(" (");
+  Serial.print((int)replay.size());
+  Serial.println(" points)");
+  return true;
+}
+
+void Sensor::useSyntheticBreath(const SyntheticBreathParams& params) {
+  synthetic.init(params);
+  source = SOURCE_SYNTHETIC;
+  startTrace();
+
+  Serial.print("Synthetic breathing: ");
+  Serial.print(params.rateBpm, 1);
+  Serial.print(" bpm, ");
+  Serial.print(params.depthPa, 1);
+  Serial.println(" Pa");
+}
+
+bool Sensor::recordTrace(const char* path) {
+  if (!recorder.open(path)) {
+    Serial.print("Could not open trace for writing: ");
+    Serial.println(path);
+    return false;
+  }
+  Serial.print("Recording trace: ");
+  Serial.println(path);
+  return true;
+}
+
+bool Sensor::isTraceFinished() const {
+  return source == SOURCE_REPLAY && !hasPending;
+}
+
 void Sensor::setMouseY(int mouseY, int windowHeight) {
-  _mouseY = mouseY;
-  _windowHeight = windowHeight;
+  _windowHeight.store(windowHeight, std::memory_order_relaxed);
+  _mouseY.store(mouseY, std::memory_order_relaxed);
+}
+
+void Sensor::setProfile(SensorProfile newProfile) {
+  profile = newProfile;
+  Serial.print("Sensor profile: ");
+  Serial.println(getSensorProfileConfig(profile).name);
 }
 
 void Sensor::update() {
+  unsigned long start = micros();
+
+  if (source == SOURCE_MOUSE) {
+    updateFromMouse();
+  } else {
+    updateFromTrace();
+  }
+
+  // Record each new reading once (trace playback may repeat the last one)
+  static unsigned long lastRecordedTime = 0;
+  if (recorder.isOpen() && (sampleTime != lastRecordedTime || sampleTime == 0)) {
+    recorder.write({ sampleTime, currentPressure, currentTemperature });
+    lastRecordedTime = sampleTime;
+  }
+
+  // No I2C bus in the simulator
+  readBytes = 0;
+  readMicros = micros() - start;
+}
+
+void Sensor::updateFromTrace() {
+  if (!hasPending) return;  // Replay finished: hold the last reading
+
+  TracePoint point = pending;
+  if (_freeRunning) {
+    // One point per call, as fast as the caller consumes them
+    hasPending = nextTracePoint(pending);
+  } else {
+    // Take the newest point at or before the current (trace-relative) time
+    unsigned long traceNow = traceFirstTimestamp + (millis() - traceStartMillis);
+    if (pending.timestamp > traceNow) return;
+    while ((hasPending = nextTracePoint(pending)) && pending.timestamp <= traceNow) {
+      point = pending;
+    }
+  }
+
+  sampleTime = traceStartMillis + (point.timestamp - traceFirstTimestamp);
+  currentPressure = point.pressure;
+  currentTemperature = point.temperature;
+  pressureDelta = currentPressure - baselinePressure;
+}
+
+void Sensor::updateFromMouse() {
+  sampleTime = millis();
+
   // Map mouse Y to pressure delta
   // Center of window = 0 Pa
   // Top of window = +50 Pa (exhale)
   // Bottom of window = -50 Pa (inhale)
-  int centerY = _windowHeight / 2;
-  float normalizedY = (float)(_mouseY - centerY) / (float)centerY;  // -1 to +1
+  int centerY = _windowHeight.load(std::memory_order_relaxed) / 2;
+  int mouseY = _mouseY.load(std::memory_order_relaxed);
+  float normalizedY = (float)(mouseY - centerY) / (float)centerY;  // -1 to +1
 
   // Scale to pressure range (±50 Pa is typical breath range)
   // Negate so up = exhale (positive), down = inhale (negative)
-  pressureDelta = -normalizedY * 50.0f;
+  float targetDelta = -normalizedY * 50.0f;
+
+  // Model the BMP280 in normal mode: a new conversion every 1/ODR, with
+  // oversampling-dependent noise smoothed by the IIR filter
+  const SensorProfileConfig& config = getSensorProfileConfig(profile);
+  float now = (float)millis();
+  if (now >= _nextConversionMs) {
+    float periodMs = 1000.0f / expectedOutputDataRate(config);
+    _nextConversionMs = (now - _nextConversionMs > periodMs) ? now + periodMs
+                                                              : _nextConversionMs + periodMs;
+
+    float noise = SIM_NOISE_PA * gaussianNoise() / sqrtf((float)config.pressureOversampling);
+    _filteredDelta += (targetDelta + noise - _filteredDelta) / config.filterCoefficient;
+    pressureDelta = _filteredDelta;
 
-  // Update absolute pressure for display
-  currentPressure = baselinePressure + pressureDelta;
+    // Update absolute pressure for display
+    currentPressure = baselinePressure + pressureDelta;
+  }
 }
@@ -1,29 +1,130 @@
-// Simulator implementation of Storage (in-memory)
+// Simulator implementation of Storage
+// The session log region is a RAM image of erased flash and the settings
+// record a RAM copy, both optionally loaded from and written through to
+// a file (the log, then the settings area), with optional per-operation
+// latency. There are no legacy calibration keys.
+#include <cstdio>
 #include "Storage.h"
 #include "config.h"
+#include "Platform.h"
 
 extern SerialMock Serial;
 
-static float savedInhaleThreshold = DEFAULT_INHALE_THRESHOLD;
-static float savedExhaleThreshold = DEFAULT_EXHALE_THRESHOLD;
+static const uint32_t LOG_SIZE = SESSION_LOG_SECTORS * Storage::LOG_SECTOR_SIZE;
+static uint8_t logImage[LOG_SIZE];
+
+// Settings area after the log in the file: the record's size, then the record
+static const uint32_t SETTINGS_AREA_SIZE = 256;
+static uint8_t settingsRecord[SETTINGS_AREA_SIZE - sizeof(uint32_t)];
+static uint32_t settingsSize = 0;
+
+static const char* logPath = nullptr;
+static FILE* logFile = nullptr;
+static uint32_t writeLatencyMs = 0;
+static uint32_t eraseLatencyMs = 0;
+
+void Storage::useFile(const char* path) {
+  logPath = path;
+}
+
+void Storage::setLatency(uint32_t writeMs, uint32_t eraseMs) {
+  writeLatencyMs = writeMs;
+  eraseLatencyMs = eraseMs;
+}
 
 void Storage::init() {
-  Serial.println("Storage initialized (in-memory)");
+  memset(logImage, 0xFF, sizeof(logImage));
+
+  if (logPath) {
+    // Existing image (shorter files read as erased), else a new one
+    logFile = fopen(logPath, "r+b");
+    if (logFile) {
+      size_t loaded = fread(logImage, 1, sizeof(logImage), logFile);
+      // Settings follow a complete log image (older files have none)
+      uint32_t size = 0;
+      if (loaded == sizeof(logImage) && fread(&size, sizeof(size), 1, logFile) == 1 &&
+          size <= sizeof(settingsRecord) && fread(settingsRecord, 1, size, logFile) == size) {
+        settingsSize = size;
+      }
+    } else {
+      logFile = fopen(logPath, "w+b");
+    }
+    if (!logFile) {
+      Serial.print("Cannot open storage file ");
+      Serial.println(logPath);
+    } else {
+      fseek(logFile, 0, SEEK_SET);
+      fwrite(logImage, 1, sizeof(logImage), logFile);
+      fwrite(&settingsSize, sizeof(settingsSize), 1, logFile);
+      fwrite(settingsRecord, 1, settingsSize, logFile);
+      fflush(logFile);
+    }
+  }
+
+  Serial.println(logFile ? "Storage initialized (file-backed log)" : "Storage initialized (in-memory)");
 }
 
-void Storage::loadCalibration(float& inhaleThreshold, float& exhaleThreshold) {
-  inhaleThreshold = savedInhaleThreshold;
-  exhaleThreshold = savedExhaleThreshold;
+size_t Storage::readSettings(void* data, size_t capacity) {
+  if (settingsSize == 0 || settingsSize > capacity) return 0;
+  memcpy(data, settingsRecord, settingsSize);
+  return settingsSize;
+}
+
+bool Storage::writeSettings(const void* data, size_t size) {
+  if (size > sizeof(settingsRecord)) return false;
+  if (writeLatencyMs) delay(writeLatencyMs);
+  memcpy(settingsRecord, data, size);
+  settingsSize = size;
+  if (logFile) {
+    fseek(logFile, LOG_SIZE, SEEK_SET);
+    fwrite(&settingsSize, sizeof(settingsSize), 1, logFile);
+    fwrite(settingsRecord, 1, settingsSize, logFile);
+    fflush(logFile);
+  }
+  return true;
+}
+
+bool Storage::readLegacyCalibration(float&, float&) {
+  return false;
+}
+
+void Storage::removeLegacyCalibration() {
+}
+
+uint32_t Storage::getLogSize() const {
+  return LOG_SIZE;
+}
+
+// Write a changed range of the image through to the file
+static void writeThrough(uint32_t offset, size_t size) {
+  if (!logFile) return;
+  fseek(logFile, offset, SEEK_SET);
+  fwrite(logImage + offset, 1, size, logFile);
+  fflush(logFile);
+}
+
+bool Storage::eraseLogSector(uint32_t offset) {
+  if (offset % LOG_SECTOR_SIZE || offset + LOG_SECTOR_SIZE > LOG_SIZE) return false;
+  if (eraseLatencyMs) delay(eraseLatencyMs);
+  memset(logImage + offset, 0xFF, LOG_SECTOR_SIZE);
+  writeThrough(offset, LOG_SECTOR_SIZE);
+  return true;
+}
 
-  Serial.print("Loaded calibration - Inhale: ");
-  Serial.print(inhaleThreshold);
-  Serial.print(" Pa, Exhale: ");
-  Serial.print(exhaleThreshold);
-  Serial.println(" Pa");
+bool Storage::writeLog(uint32_t offset, const void* data, size_t size) {
+  if (offset + size > LOG_SIZE) return false;
+  if (writeLatencyMs) delay(writeLatencyMs);
+  // NOR flash: programming only clears bits
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; i++) {
+    logImage[offset + i] &= bytes[i];
+  }
+  writeThrough(offset, size);
+  return true;
 }
 
-void Storage::saveCalibration(float inhaleThreshold, float exhaleThreshold) {
-  savedInhaleThreshold = inhaleThreshold;
-  savedExhaleThreshold = exhaleThreshold;
-  Serial.println("Calibration saved (in-memory)");
+bool Storage::readLog(uint32_t offset, void* data, size_t size) const {
+  if (offset + size > LOG_SIZE) return false;
+  memcpy(data, logImage + offset, size);
+  return true;
 }
@@ -2,95 +2,162 @@
 #include <Arduino.h>
 
 void BreathData::init() {
-  currentState = BREATH_IDLE;
+  detector.reset();
+  rate.reset();
   breathStartTime = 0;
-  lastBreathTime = 0;
-  breathCount = 0;
-  averageBreathDuration = 0;
-  sessionStartTime = millis();
   inhaleThreshold = DEFAULT_INHALE_THRESHOLD;
   exhaleThreshold = DEFAULT_EXHALE_THRESHOLD;
-  normalizedBreath = 0;
-  minPressureDelta = -10.0f;
-  maxPressureDelta = 10.0f;
+  appliedInhaleThreshold = inhaleThreshold;
+  appliedExhaleThreshold = exhaleThreshold;
+  detector.setThresholds(inhaleThreshold, exhaleThreshold);
+  resetSession();
 }
 
 void BreathData::detect(float pressureDelta) {
-  BreathState previousState = currentState;
-  unsigned long now = millis();
-
-  // Expand calibration bounds only when exceeding overage threshold
-  // This filters out small noise spikes that would otherwise shrink normalized values
-  if (pressureDelta < minPressureDelta * NORM_OVERAGE_THRESHOLD && minPressureDelta < -0.1f) {
-    // Inhale exceeds threshold - expand gradually
-    float ratio = pressureDelta / (minPressureDelta * NORM_OVERAGE_THRESHOLD);
-    minPressureDelta *= ratio;
+  detect(pressureDelta, millis());
+}
+
+void BreathData::detect(float pressureDelta, unsigned long timestamp) {
+  Sample sample = {};
+  sample.timestamp = timestamp;
+  sample.pressureDelta = pressureDelta;
+  detectBlock(&sample, 1);
+}
+
+size_t BreathData::detectBlock(const Sample* samples, size_t count,
+                               BreathTransition* transitions, size_t maxTransitions) {
+  // Thresholds are public (loaded from storage); convert them only on change
+  if (inhaleThreshold != appliedInhaleThreshold || exhaleThreshold != appliedExhaleThreshold) {
+    appliedInhaleThreshold = inhaleThreshold;
+    appliedExhaleThreshold = exhaleThreshold;
+    detector.setThresholds(inhaleThreshold, exhaleThreshold);
   }
-  if (pressureDelta > maxPressureDelta * NORM_OVERAGE_THRESHOLD && maxPressureDelta > 0.1f) {
-    // Exhale exceeds threshold - expand gradually
-    float ratio = pressureDelta / (maxPressureDelta * NORM_OVERAGE_THRESHOLD);
-    maxPressureDelta *= ratio;
+
+  size_t found = 0;
+  BreathState state = detector.getState();
+  for (size_t i = 0; i < count; i++) {
+    float pressureDelta = samples[i].pressureDelta;
+    rate.add(pressureDelta, samples[i].timestamp);
+
+    // Pressure swing of the current cycle
+    if (pressureDelta < cycleMinDelta) cycleMinDelta = pressureDelta;
+    if (pressureDelta > cycleMaxDelta) cycleMaxDelta = pressureDelta;
+
+    if (!detector.detect(BreathSample(pressureDelta), samples[i].timestamp)) continue;
+
+    BreathState next = detector.getState();
+    onTransition(state, next, samples[i].timestamp, pressureDelta);
+    if (found < maxTransitions) {
+      transitions[found] = { samples[i].timestamp, state, next };
+    }
+    found++;
+    state = next;
   }
+  return found;
+}
+
+void BreathData::publishSnapshot(const Sample& newest) {
+  BreathSnapshot& snapshot = snapshots.edit();
+  snapshot.state = getState();
+  snapshot.breathCount = getBreathCount();
+  snapshot.normalized = getNormalizedBreath();
+  snapshot.minDelta = getMinDelta();
+  snapshot.maxDelta = getMaxDelta();
+  snapshot.rate = getBreathRate();
+  snapshot.rateConfidence = getBreathRateConfidence();
+  snapshot.pressureDelta = newest.pressureDelta;
+  snapshot.pressure = newest.pressure;
+  snapshot.temperature = newest.temperature;
+  snapshot.hasSample = true;
+  snapshot.captureMicros = newest.captureMicros;
+  snapshot.readMicros = newest.readMicros;
+  snapshot.detectMicros = micros();
+  snapshots.publish();
+}
 
-  // Calculate normalized breath (-1 to +1)
-  if (pressureDelta < 0 && minPressureDelta < -0.1f) {
-    // Inhale: map [minPressureDelta..0] → [-1..0]
-    normalizedBreath = pressureDelta / (-minPressureDelta);
-  } else if (pressureDelta > 0 && maxPressureDelta > 0.1f) {
-    // Exhale: map [0..maxPressureDelta] → [0..1]
-    normalizedBreath = pressureDelta / maxPressureDelta;
-  } else {
-    normalizedBreath = 0;
+void BreathData::onTransition(BreathState from, BreathState to, unsigned long now,
+                              float pressureDelta) {
+  // Time spent in the state that just ended
+  if (cycleStarted) {
+    unsigned long elapsed = now - breathStartTime;
+    if (from == BREATH_INHALE) currentCycle.inhaleMs += elapsed;
+    else if (from == BREATH_EXHALE) currentCycle.exhaleMs += elapsed;
+    else if (from == BREATH_HOLD) currentCycle.holdMs += elapsed;
   }
+  breathStartTime = now;
 
-  // Clamp to valid range
-  if (normalizedBreath < -1.0f) normalizedBreath = -1.0f;
-  if (normalizedBreath > 1.0f) normalizedBreath = 1.0f;
-
-  // Detect breath state based on pressure delta
-  if (pressureDelta < inhaleThreshold) {
-    currentState = BREATH_INHALE;
-  } else if (pressureDelta > exhaleThreshold) {
-    currentState = BREATH_EXHALE;
-  } else {
-    // Check for breath hold (stable pressure for >3 seconds)
-    if (now - lastBreathTime > BREATH_HOLD_TIMEOUT_MS &&
-        abs(pressureDelta) < BREATH_HOLD_STABILITY_PA) {
-      currentState = BREATH_HOLD;
-    } else {
-      currentState = BREATH_IDLE;
-    }
+  if (to == BREATH_EXHALE) {
+    exhaleSeen = true;
+    return;
   }
+  if (to != BREATH_INHALE) return;
 
-  // Detect breath transitions for counting
-  if (previousState != currentState) {
-    breathStartTime = now;
-
-    // Count a full breath cycle when transitioning from exhale to inhale
-    if (previousState == BREATH_EXHALE && currentState == BREATH_INHALE) {
-      breathCount++;
-
-      // Update average breath duration
-      unsigned long cycleDuration = now - lastBreathTime;
-      if (breathCount == 1) {
-        averageBreathDuration = cycleDuration;
-      } else {
-        averageBreathDuration =
-          (averageBreathDuration * (breathCount - 1) + cycleDuration) / breathCount;
-      }
-    }
+  // A cycle runs from one inhale start to the next inhale start that
+  // follows an exhale (detection passes through IDLE in between)
+  if (cycleStarted && !exhaleSeen) return;
+
+  if (cycleStarted) {
+    currentCycle.durationMs = now - cycleStartTime;
+    currentCycle.depthPa = cycleMaxDelta - cycleMinDelta;
+    if (currentCycle.durationMs <= BREATH_CYCLE_MAX_MS) {
+      if (sessionStats.getBreathCount() == 0) firstBreathTime = cycleStartTime;
+      lastBreathTime = now;
+      sessionStats.add(currentCycle);
 
-    lastBreathTime = now;
+      BreathRecord record;
+      record.startTime = cycleStartTime;
+      record.inhaleMs = currentCycle.inhaleMs;
+      record.exhaleMs = currentCycle.exhaleMs;
+      record.peakInhalePa = cycleMinDelta < 0 ? cycleMinDelta : 0;
+      record.peakExhalePa = cycleMaxDelta > 0 ? cycleMaxDelta : 0;
+      record.held = currentCycle.holdMs > 0;
+      breathLog.add(record);
+    }
   }
+
+  cycleStarted = true;
+  cycleStartTime = now;
+  currentCycle = BreathCycle();
+  exhaleSeen = false;
+  cycleMinDelta = pressureDelta;
+  cycleMaxDelta = pressureDelta;
 }
 
 void BreathData::resetSession() {
-  breathCount = 0;
-  averageBreathDuration = 0;
+  sessionStats.reset();
+  breathLog.clear();
+  cycleStarted = false;
+  exhaleSeen = false;
   sessionStartTime = millis();
 }
 
+bool BreathData::isSessionIdle(unsigned long now) const {
+  // Signed: a sample older than the last breath is not idle time
+  return sessionStats.getBreathCount() > 0 &&
+         (long)(now - lastBreathTime) >= (long)SESSION_IDLE_TIMEOUT_MS;
+}
+
+bool BreathData::finishSession(SessionSummary& summary) {
+  const MetricStats& cycle = sessionStats.getCycleDuration();
+  bool keep = sessionStats.getBreathCount() >= SESSION_MIN_BREATHS && cycle.getMin() > 0;
+  if (keep) {
+    unsigned long breaths = sessionStats.getBreathCount();
+    summary = SessionSummary();
+    summary.durationMs = lastBreathTime - firstBreathTime;
+    summary.breathCount = breaths > 0xFFFF ? 0xFFFF : (uint16_t)breaths;
+    summary.meanRateBpm = 60000.0f / cycle.getMean();
+    summary.medianRateBpm = 60000.0f / cycle.getMedian();
+    summary.minRateBpm = 60000.0f / cycle.getMax();
+    summary.maxRateBpm = 60000.0f / cycle.getMin();
+  }
+  resetSession();
+  return keep;
+}
+
 void BreathData::resetCalibration() {
-  minPressureDelta = -10.0f;
-  maxPressureDelta = 10.0f;
+  detector.resetBounds();
+}
+
+void BreathData::setCalibration(float minDelta, float maxDelta) {
+  detector.setBounds(BreathSample(minDelta), BreathSample(maxDelta));
 }
@@ -2,6 +2,48 @@
 #define BREATH_DATA_H
 
 #include "config.h"
+#include "BreathDetector.h"
+#include "BreathLog.h"
+#include "BreathRate.h"
+#include "SampleRing.h"
+#include "SessionLog.h"
+#include "SessionStats.h"
+#include "SnapshotBuffer.h"
+
+// Sample type for the detection and normalization math
+#if BREATH_FIXED_POINT
+using BreathSample = Q16;
+#else
+using BreathSample = float;
+#endif
+
+// A breath state change and the sample time it happened at
+struct BreathTransition {
+  unsigned long timestamp;
+  BreathState from;
+  BreathState to;
+};
+
+// What the render side shows, published once per detection pass
+struct BreathSnapshot {
+  BreathState state;
+  int breathCount;
+  float normalized;       // -1 (max inhale) to +1 (max exhale)
+  float minDelta;         // Calibration bounds
+  float maxDelta;
+  float rate;             // Breaths per minute
+  float rateConfidence;
+  float pressureDelta;    // Newest filtered delta (Pa)
+  float pressure;         // Newest absolute pressure (Pa)
+  float temperature;      // Celsius
+  bool hasSample;         // False until the first pass with samples
+
+  // Newest sample's capture and read time, and when detection finished
+  // with it (latency tracing)
+  uint32_t captureMicros;
+  uint32_t readMicros;
+  uint32_t detectMicros;
+};
 
 class BreathData {
 public:
@@ -11,42 +53,97 @@ public:
   // Update breath detection based on current pressure
   void detect(float pressureDelta);
 
+  // Update breath detection with a sample captured at a known time
+  void detect(float pressureDelta, unsigned long timestamp);
+
+  // Run detection over timestamped samples in one pass. Every state change
+  // inside the block is reported: up to maxTransitions are written to
+  // transitions (which may be null), and the total is returned.
+  size_t detectBlock(const Sample* samples, size_t count,
+                     BreathTransition* transitions = nullptr, size_t maxTransitions = 0);
+
+  // Detection side: publish the current state with the newest sample
+  // of the pass (its pressureDelta already filtered)
+  void publishSnapshot(const Sample& newest);
+
+  // Render side: newest published state. Lock-free, so detection may run
+  // on another core; one reader only, and the reference stays valid until
+  // the next call.
+  const BreathSnapshot& readSnapshot() { return snapshots.read(); }
+
   // Reset session statistics
   void resetSession();
 
+  // True when the session has breaths but none completed in the
+  // SESSION_IDLE_TIMEOUT_MS before now (a sample timestamp)
+  bool isSessionIdle(unsigned long now) const;
+
+  // End the session and start a new one. Returns true with its summary
+  // when it had at least SESSION_MIN_BREATHS breaths.
+  bool finishSession(SessionSummary& summary);
+
   // Reset min/max calibration bounds
   void resetCalibration();
 
+  // Restore calibration bounds from settings (before detection starts)
+  void setCalibration(float minDelta, float maxDelta);
+
   // Getters
-  BreathState getState() const { return currentState; }
-  int getBreathCount() const { return breathCount; }
-  float getAverageBreathDuration() const { return averageBreathDuration; }
+  BreathState getState() const { return detector.getState(); }
+  int getBreathCount() const { return (int)sessionStats.getBreathCount(); }
+  float getAverageBreathDuration() const { return sessionStats.getCycleDuration().getMean(); }
+  const SessionStats& getSessionStats() const { return sessionStats; }
+  const BreathLog& getBreathLog() const { return breathLog; }
   unsigned long getSessionStartTime() const { return sessionStartTime; }
   unsigned long getBreathStartTime() const { return breathStartTime; }
 
+  // Dominant breathing rate (breaths per minute) and its confidence (0-1),
+  // estimated from the pressure waveform rather than threshold crossings
+  float getBreathRate() const { return rate.getRate(); }
+  float getBreathRateConfidence() const { return rate.getConfidence(); }
+
   // Normalized breath: -1 (max inhale) to +1 (max exhale)
-  float getNormalizedBreath() const { return normalizedBreath; }
+  float getNormalizedBreath() const { return toFloat(detector.getNormalized()); }
 
   // Calibration bounds (for diagnostics)
-  float getMinDelta() const { return minPressureDelta; }
-  float getMaxDelta() const { return maxPressureDelta; }
+  float getMinDelta() const { return toFloat(detector.getMinDelta()); }
+  float getMaxDelta() const { return toFloat(detector.getMaxDelta()); }
 
   // Calibration thresholds
   float inhaleThreshold;
   float exhaleThreshold;
 
 private:
-  BreathState currentState = BREATH_IDLE;
+  // Track phase times and complete breath cycles for one state change
+  void onTransition(BreathState from, BreathState to, unsigned long timestamp,
+                    float pressureDelta);
+
+  BreathDetector<BreathSample> detector;
+  BreathRate rate;
+
+  // Thresholds last handed to the detector (converted only on change)
+  float appliedInhaleThreshold = 0;
+  float appliedExhaleThreshold = 0;
+
   unsigned long breathStartTime = 0;
-  unsigned long lastBreathTime = 0;
-  int breathCount = 0;
-  float averageBreathDuration = 0;
   unsigned long sessionStartTime = 0;
 
-  // Normalization
-  float normalizedBreath = 0;
-  float minPressureDelta = -10.0f;  // Initial estimate (inhale)
-  float maxPressureDelta = 10.0f;   // Initial estimate (exhale)
+  // Start of the session's first counted breath and end of its last
+  unsigned long firstBreathTime = 0;
+  unsigned long lastBreathTime = 0;
+
+  // Breath cycle in progress
+  bool cycleStarted = false;
+  bool exhaleSeen = false;
+  unsigned long cycleStartTime = 0;
+  BreathCycle currentCycle = BreathCycle();
+  float cycleMinDelta = 0;
+  float cycleMaxDelta = 0;
+
+  SessionStats sessionStats;
+  BreathLog breathLog;
+
+  SnapshotBuffer<BreathSnapshot> snapshots;
 };
 
 // Global breath data instance (defined in main.cpp)
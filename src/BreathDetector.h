@@ -0,0 +1,124 @@
+#ifndef BREATH_DETECTOR_H
+#define BREATH_DETECTOR_H
+
+#include "config.h"
+#include "FixedPoint.h"
+
+// Breath state machine and asymmetric normalization, templated on the
+// sample type so the same logic runs in float or Q16 fixed point.
+// The per-sample path uses only compares, adds and multiplies: bounds are
+// stored with their reciprocals, which are recomputed only on expansion.
+template <typename T>
+class BreathDetector {
+public:
+  void reset() {
+    state = BREATH_IDLE;
+    lastTransitionTime = 0;
+    normalized = T(0.0f);
+    resetBounds();
+  }
+
+  // Reset min/max calibration bounds
+  void resetBounds() {
+    setMinDelta(T(DEFAULT_MIN_DELTA));
+    setMaxDelta(T(DEFAULT_MAX_DELTA));
+  }
+
+  // Restore bounds learned earlier (minDelta < 0 < maxDelta; both are
+  // clamped to BOUND_MIN_PA..BOUND_MAX_PA in magnitude)
+  void setBounds(T min, T max) {
+    setMinDelta(min);
+    setMaxDelta(max);
+  }
+
+  void setThresholds(float inhale, float exhale) {
+    inhaleThreshold = T(inhale);
+    exhaleThreshold = T(exhale);
+  }
+
+  // Process one sample; returns true when the breath state changed
+  bool detect(T pressureDelta, unsigned long now) {
+    const T overage = T(NORM_OVERAGE_THRESHOLD);
+    const T invOverage = T(1.0f / NORM_OVERAGE_THRESHOLD);
+    const T holdStability = T(BREATH_HOLD_STABILITY_PA);
+    const T one = T(1.0f);
+    const T zero = T(0.0f);
+
+    // Expand calibration bounds only when exceeding overage threshold.
+    // Scaling the bound by delta / (bound * overage) is delta / overage.
+    if (pressureDelta < minDelta * overage) {
+      setMinDelta(pressureDelta * invOverage);
+    }
+    if (pressureDelta > maxDelta * overage) {
+      setMaxDelta(pressureDelta * invOverage);
+    }
+
+    // Normalize: inhale [minDelta..0] -> [-1..0], exhale [0..maxDelta] -> [0..1]
+    // (the bounds are never within BOUND_MIN_PA of zero)
+    if (pressureDelta < zero) {
+      normalized = pressureDelta * invMinRange;
+    } else if (pressureDelta > zero) {
+      normalized = pressureDelta * invMaxRange;
+    } else {
+      normalized = zero;
+    }
+    if (normalized < -one) normalized = -one;
+    if (normalized > one) normalized = one;
+
+    // Breath state from pressure thresholds
+    BreathState previousState = state;
+    if (pressureDelta < inhaleThreshold) {
+      state = BREATH_INHALE;
+    } else if (pressureDelta > exhaleThreshold) {
+      state = BREATH_EXHALE;
+    } else if ((state == BREATH_HOLD || now - lastTransitionTime > BREATH_HOLD_TIMEOUT_MS) &&
+               pressureDelta < holdStability && pressureDelta > -holdStability) {
+      // Stable pressure for longer than the hold timeout (held while stable)
+      state = BREATH_HOLD;
+    } else {
+      state = BREATH_IDLE;
+    }
+
+    if (state == previousState) return false;
+    lastTransitionTime = now;
+    return true;
+  }
+
+  BreathState getState() const { return state; }
+  unsigned long getLastTransitionTime() const { return lastTransitionTime; }
+
+  // Normalized breath: -1 (max inhale) to +1 (max exhale)
+  T getNormalized() const { return normalized; }
+  T getMinDelta() const { return minDelta; }
+  T getMaxDelta() const { return maxDelta; }
+
+private:
+  // Clamp before taking the reciprocal: a bound at or near zero would
+  // divide by zero in Q16, one near the edge of its range overflow
+  void setMinDelta(T value) {
+    if (!(value < T(-BOUND_MIN_PA))) value = T(-BOUND_MIN_PA);
+    if (value < T(-BOUND_MAX_PA)) value = T(-BOUND_MAX_PA);
+    minDelta = value;
+    invMinRange = T(1.0f) / -value;
+  }
+
+  void setMaxDelta(T value) {
+    if (!(value > T(BOUND_MIN_PA))) value = T(BOUND_MIN_PA);
+    if (value > T(BOUND_MAX_PA)) value = T(BOUND_MAX_PA);
+    maxDelta = value;
+    invMaxRange = T(1.0f) / value;
+  }
+
+  BreathState state = BREATH_IDLE;
+  unsigned long lastTransitionTime = 0;
+
+  T normalized = T(0.0f);
+  T minDelta = T(-10.0f);       // Initial estimate (inhale)
+  T maxDelta = T(10.0f);        // Initial estimate (exhale)
+  T invMinRange = T(0.1f);
+  T invMaxRange = T(0.1f);
+  T inhaleThreshold = T(DEFAULT_INHALE_THRESHOLD);
+  T exhaleThreshold = T(DEFAULT_EXHALE_THRESHOLD);
+};
+
+#endif // BREATH_DETECTOR_H
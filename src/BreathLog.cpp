@@ -0,0 +1,97 @@
+#include "BreathLog.h"
+
+static const int DURATION_SHIFT = BreathLog::START_BITS;
+static const int INHALE_PEAK_SHIFT = DURATION_SHIFT + 2 * BreathLog::DURATION_BITS;
+static const int EXHALE_PEAK_SHIFT = INHALE_PEAK_SHIFT + BreathLog::PEAK_BITS;
+static const int HOLD_SHIFT = EXHALE_PEAK_SHIFT + BreathLog::PEAK_BITS;
+
+static uint64_t field(uint64_t entry, int shift, int bits) {
+  return (entry >> shift) & ((1ULL << bits) - 1);
+}
+
+// Round and clamp to an unsigned field
+static uint64_t saturate(float value, int bits) {
+  const float maxValue = (float)((1UL << bits) - 1);
+  if (!(value > 0)) return 0;
+  if (value >= maxValue) return (uint64_t)maxValue;
+  return (uint64_t)(value + 0.5f);
+}
+
+void BreathLog::clear() {
+  first = 0;
+  count = 0;
+  oldestStartTime = 0;
+  newestRecord = BreathRecord();
+}
+
+void BreathLog::add(const BreathRecord& record) {
+  unsigned long startDelta = count > 0 ? record.startTime - newestRecord.startTime : 0;
+
+  uint64_t entry = saturate((float)startDelta, START_BITS);
+  entry |= saturate(record.inhaleMs / 10.0f, DURATION_BITS) << DURATION_SHIFT;
+  entry |= saturate(record.exhaleMs / 10.0f, DURATION_BITS) << (DURATION_SHIFT + DURATION_BITS);
+  entry |= saturate(-record.peakInhalePa * 2.0f, PEAK_BITS) << INHALE_PEAK_SHIFT;
+  entry |= saturate(record.peakExhalePa * 2.0f, PEAK_BITS) << EXHALE_PEAK_SHIFT;
+  entry |= (uint64_t)(record.held ? 1 : 0) << HOLD_SHIFT;
+
+  // Start time as a reader decodes it (short of the true start when the
+  // gap saturated START_BITS)
+  unsigned long decodedStart = count > 0 ? newestRecord.startTime + field(entry, 0, START_BITS)
+                                         : record.startTime;
+
+  if (count == 0) {
+    oldestStartTime = record.startTime;
+  }
+  if (count == BREATH_LOG_SIZE) {
+    // Overwrite the oldest; the next one becomes the time anchor
+    first = (first + 1) % BREATH_LOG_SIZE;
+    count--;
+    oldestStartTime += field(entryAt(0), 0, START_BITS);
+  }
+  entries[(first + count) % BREATH_LOG_SIZE] = entry;
+  count++;
+
+  // Keep the newest record exactly as decoded, start included, so the
+  // next delta is taken from the time a reader sees and a saturated gap
+  // is made up by the following breaths
+  newestRecord = *Iterator(this, count - 1, decodedStart);
+}
+
+BreathRecord BreathLog::Iterator::operator*() const {
+  uint64_t entry = log->entryAt(position);
+
+  BreathRecord record;
+  record.startTime = startTime;
+  record.inhaleMs = field(entry, DURATION_SHIFT, DURATION_BITS) * 10;
+  record.exhaleMs = field(entry, DURATION_SHIFT + DURATION_BITS, DURATION_BITS) * 10;
+  record.peakInhalePa = -0.5f * field(entry, INHALE_PEAK_SHIFT, PEAK_BITS);
+  record.peakExhalePa = 0.5f * field(entry, EXHALE_PEAK_SHIFT, PEAK_BITS);
+  record.held = field(entry, HOLD_SHIFT, 1) != 0;
+  return record;
+}
+
+BreathLog::Iterator& BreathLog::Iterator::operator++() {
+  position++;
+  if (position < log->count) {
+    startTime += field(log->entryAt(position), 0, START_BITS);
+  }
+  return *this;
+}
+
+void dumpBreathLog(const BreathLog& log) {
+  Serial.println("start_ms,inhale_ms,exhale_ms,peak_inhale_pa,peak_exhale_pa,hold");
+  for (BreathLog::Iterator it = log.begin(); it != log.end(); ++it) {
+    BreathRecord record = *it;
+    Serial.print((int)record.startTime);
+    Serial.print(",");
+    Serial.print((int)record.inhaleMs);
+    Serial.print(",");
+    Serial.print((int)record.exhaleMs);
+    Serial.print(",");
+    Serial.print(record.peakInhalePa, 1);
+    Serial.print(",");
+    Serial.print(record.peakExhalePa, 1);
+    Serial.print(",");
+    Serial.println(record.held ? 1 : 0);
+  }
+}
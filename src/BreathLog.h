@@ -0,0 +1,76 @@
+#ifndef BREATH_LOG_H
+#define BREATH_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// One breath as read back from the log
+struct BreathRecord {
+  unsigned long startTime;  // millis() at inhale start
+  uint16_t inhaleMs;
+  uint16_t exhaleMs;
+  float peakInhalePa;       // Most negative delta (<= 0)
+  float peakExhalePa;       // Most positive delta (>= 0)
+  bool held;                // A breath hold occurred in the cycle
+};
+
+// Bounded ring of the most recent breaths, 8 bytes each. Start times are
+// stored as the delta from the previous breath, durations in 10 ms units
+// and peaks in 0.5 Pa units; out-of-range values saturate. Deltas are
+// taken from the previous start as decoded, so a saturated gap is made up
+// by the following breaths instead of offsetting every later start. The
+// oldest entry is overwritten when the ring is full.
+class BreathLog {
+public:
+  // Packed field widths (63 of 64 bits used)
+  static const int START_BITS = 22;     // ms since previous start (~70 min)
+  static const int DURATION_BITS = 11;  // 10 ms units (20.47 s)
+  static const int PEAK_BITS = 9;       // 0.5 Pa units (255.5 Pa)
+
+  void clear();
+  void add(const BreathRecord& record);
+
+  size_t size() const { return count; }
+  static size_t capacity() { return BREATH_LOG_SIZE; }
+  size_t memoryBytes() const { return sizeof(entries); }
+
+  // Most recent breath (log must not be empty)
+  BreathRecord newest() const { return newestRecord; }
+
+  // Decodes records oldest to newest straight out of the ring
+  class Iterator {
+  public:
+    BreathRecord operator*() const;
+    Iterator& operator++();
+    bool operator!=(const Iterator& other) const { return position != other.position; }
+
+  private:
+    friend class BreathLog;
+    Iterator(const BreathLog* log, size_t position, unsigned long startTime)
+      : log(log), position(position), startTime(startTime) {}
+
+    const BreathLog* log;
+    size_t position;            // 0 = oldest
+    unsigned long startTime;    // Start time of the record at position
+  };
+
+  Iterator begin() const { return Iterator(this, 0, oldestStartTime); }
+  Iterator end() const { return Iterator(this, count, 0); }
+
+private:
+  uint64_t entryAt(size_t position) const {
+    return entries[(first + position) % BREATH_LOG_SIZE];
+  }
+
+  uint64_t entries[BREATH_LOG_SIZE];
+  size_t first = 0;
+  size_t count = 0;
+  unsigned long oldestStartTime = 0;
+  BreathRecord newestRecord = BreathRecord();
+};
+
+// Print every logged breath as CSV over Serial
+void dumpBreathLog(const BreathLog& log);
+
+#endif // BREATH_LOG_H
@@ -0,0 +1,118 @@
+#include "BreathRate.h"
+#include <math.h>
+
+#ifndef M_PI
+  #define M_PI 3.14159265358979323846
+#endif
+
+// Per-step damping keeps the sliding DFT stable against rounding drift
+static const float DAMPING = 0.9999f;
+
+void BreathRate::reset() {
+  bucketSum = 0;
+  bucketCount = 0;
+  started = false;
+
+  for (int i = 0; i < RATE_WINDOW; i++) {
+    window[i] = 0;
+  }
+  windowIndex = 0;
+  filled = 0;
+
+  for (int b = 0; b < RATE_BIN_COUNT; b++) {
+    int k = RATE_FIRST_BIN - 1 + b;
+    float w = 2.0f * (float)M_PI * k / RATE_WINDOW;
+    binRe[b] = 0;
+    binIm[b] = 0;
+    twiddleRe[b] = DAMPING * cosf(w);
+    twiddleIm[b] = DAMPING * sinf(w);
+  }
+  oldestDamping = powf(DAMPING, RATE_WINDOW);
+
+  rateBpm = 0;
+  confidence = 0;
+}
+
+void BreathRate::add(float pressureDelta, unsigned long timestamp) {
+  if (!started) {
+    bucketStart = timestamp;
+    started = true;
+  }
+
+  // Close every bucket that has ended; repeat the last value across gaps
+  while (timestamp - bucketStart >= RATE_DECIMATE_MS) {
+    float value = bucketCount > 0 ? bucketSum / bucketCount : window[(windowIndex + RATE_WINDOW - 1) % RATE_WINDOW];
+    push(value);
+    bucketSum = 0;
+    bucketCount = 0;
+    bucketStart += RATE_DECIMATE_MS;
+
+    // Restart after a gap longer than the whole window
+    if (timestamp - bucketStart >= (unsigned long)RATE_WINDOW * RATE_DECIMATE_MS) {
+      reset();
+      bucketStart = timestamp;
+      started = true;
+      break;
+    }
+  }
+
+  bucketSum += pressureDelta;
+  bucketCount++;
+}
+
+void BreathRate::push(float value) {
+  float oldest = window[windowIndex];
+  window[windowIndex] = value;
+  windowIndex = (windowIndex + 1) % RATE_WINDOW;
+  if (filled < RATE_WINDOW) filled++;
+
+  // X_k <- r e^(jw_k) (X_k + x_new - r^N x_old)
+  float delta = value - oldestDamping * oldest;
+  for (int b = 0; b < RATE_BIN_COUNT; b++) {
+    float re = binRe[b] + delta;
+    float im = binIm[b];
+    binRe[b] = re * twiddleRe[b] - im * twiddleIm[b];
+    binIm[b] = re * twiddleIm[b] + im * twiddleRe[b];
+  }
+
+  if (filled == RATE_WINDOW) estimate();
+}
+
+void BreathRate::estimate() {
+  // Hann window applied in the frequency domain, then band power
+  float power[RATE_BIN_COUNT];
+  float total = 0;
+  int peak = 1;
+  for (int b = 1; b < RATE_BIN_COUNT - 1; b++) {
+    float re = 0.5f * binRe[b] - 0.25f * (binRe[b - 1] + binRe[b + 1]);
+    float im = 0.5f * binIm[b] - 0.25f * (binIm[b - 1] + binIm[b + 1]);
+    power[b] = re * re + im * im;
+    total += power[b];
+    if (power[b] > power[peak]) peak = b;
+  }
+
+  if (total <= 0) {
+    rateBpm = 0;
+    confidence = 0;
+    return;
+  }
+
+  // Parabolic interpolation between neighboring bin magnitudes
+  float offset = 0;
+  if (peak > 1 && peak < RATE_BIN_COUNT - 2) {
+    float left = sqrtf(power[peak - 1]);
+    float center = sqrtf(power[peak]);
+    float right = sqrtf(power[peak + 1]);
+    float denominator = left - 2.0f * center + right;
+    if (denominator < 0) offset = 0.5f * (left - right) / denominator;
+  }
+
+  float bin = RATE_FIRST_BIN - 1 + peak + offset;
+  rateBpm = bin * 60000.0f / ((float)RATE_WINDOW * RATE_DECIMATE_MS);
+
+  // A Hann-windowed tone spreads over three bins
+  float peakPower = power[peak];
+  if (peak > 1) peakPower += power[peak - 1];
+  if (peak < RATE_BIN_COUNT - 2) peakPower += power[peak + 1];
+  confidence = peakPower / total;
+}
@@ -0,0 +1,59 @@
+#ifndef BREATH_RATE_H
+#define BREATH_RATE_H
+
+#include "config.h"
+
+// Bins tracked by the sliding DFT: the breathing band plus one on each
+// side for the frequency-domain Hann window
+#define RATE_FIRST_BIN  ((int)(RATE_MIN_BPM / 60.0f * RATE_WINDOW * RATE_DECIMATE_MS / 1000.0f))
+#define RATE_LAST_BIN   ((int)(RATE_MAX_BPM / 60.0f * RATE_WINDOW * RATE_DECIMATE_MS / 1000.0f + 1))
+#define RATE_BIN_COUNT  (RATE_LAST_BIN - RATE_FIRST_BIN + 3)
+
+// Streaming breathing-rate estimate that does not depend on threshold
+// crossings. Samples are averaged into RATE_DECIMATE_MS buckets by
+// timestamp; each bucket updates a sliding DFT over the last RATE_WINDOW
+// buckets, restricted to the breathing band. Cost per input sample is an
+// add, plus a fixed number of bin updates once per bucket.
+class BreathRate {
+public:
+  void reset();
+
+  // Add one pressure sample
+  void add(float pressureDelta, unsigned long timestamp);
+
+  // Dominant breathing rate in breaths per minute (0 until the window fills)
+  float getRate() const { return rateBpm; }
+
+  // Share of breathing-band power in the dominant peak, 0 (noise) to 1
+  float getConfidence() const { return confidence; }
+
+private:
+  // Slide the DFT by one decimated value
+  void push(float value);
+
+  // Find the dominant peak and update rate/confidence
+  void estimate();
+
+  // Decimation bucket being accumulated
+  float bucketSum = 0;
+  int bucketCount = 0;
+  unsigned long bucketStart = 0;
+  bool started = false;
+
+  // Last RATE_WINDOW decimated values
+  float window[RATE_WINDOW];
+  int windowIndex = 0;
+  int filled = 0;
+
+  // Sliding DFT bins RATE_FIRST_BIN - 1 .. RATE_LAST_BIN + 1
+  float binRe[RATE_BIN_COUNT];
+  float binIm[RATE_BIN_COUNT];
+  float twiddleRe[RATE_BIN_COUNT];
+  float twiddleIm[RATE_BIN_COUNT];
+  float oldestDamping = 1;
+
+  float rateBpm = 0;
+  float confidence = 0;
+};
+
+#endif // BREATH_RATE_H
@@ -1,8 +1,95 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
 #include "Display.h"
 #include "config.h"
+#include "LatencyTrace.h"
+
+static_assert(SCREEN_HEIGHT % DISPLAY_STRIP_ROWS == 0, "DISPLAY_STRIP_ROWS must divide SCREEN_HEIGHT");
 
 static Adafruit_ST7735 tft = Adafruit_ST7735(TFT_CS, TFT_DC, TFT_RST);
-static GFXcanvas16 canvas(SCREEN_WIDTH, SCREEN_HEIGHT);
+static FrameCanvas stripA(DISPLAY_STRIP_ROWS);
+static FrameCanvas stripB(DISPLAY_STRIP_ROWS);
+static FrameCanvas* const strips[DISPLAY_BUFFERS] = { &stripA, &stripB };
+static FrameDiff frameDiff;
+static BlitStats blitStats;
+
+// Buffer the next strip is drawn into
+static int drawIndex = 0;
+
+// Palette of the frame being drawn, and of the last frame sent. Until a
+// mode sets one, every index is black.
+static Palette blackPalette;
+static const Palette* drawPalette = &blackPalette;
+static const Palette* sentPalette = nullptr;
+
+// Rows of one strip buffer to send to the panel
+struct BlitRequest {
+  int buffer;
+  int originY;
+  const uint16_t* palette;
+  int spanCount;
+  RowSpan spans[BLIT_MAX_SPANS];
+};
+
+#if DISPLAY_INDEXED_COLOR
+// Rows expanded to RGB565 per SPI write (2 KB)
+static const int EXPAND_ROWS = 8;
+static uint16_t expandedRows[EXPAND_ROWS * SCREEN_WIDTH];
+
+static void sendSpans(const BlitRequest& request) {
+  const uint8_t* pixels = strips[request.buffer]->getBuffer();
+  tft.startWrite();
+  for (int i = 0; i < request.spanCount; i++) {
+    const RowSpan& span = request.spans[i];
+    tft.setAddrWindow(0, span.y, SCREEN_WIDTH, span.height);
+    for (int y = span.y; y < span.y + span.height; y += EXPAND_ROWS) {
+      int rows = min(EXPAND_ROWS, span.y + span.height - y);
+      const uint8_t* source = pixels + (y - request.originY) * SCREEN_WIDTH;
+      for (int p = 0; p < rows * SCREEN_WIDTH; p++) {
+        expandedRows[p] = request.palette[source[p]];
+      }
+      tft.writePixels(expandedRows, rows * SCREEN_WIDTH);
+    }
+  }
+  tft.endWrite();
+}
+#else
+static void sendSpans(const BlitRequest& request) {
+  uint16_t* pixels = strips[request.buffer]->getBuffer();
+  for (int i = 0; i < request.spanCount; i++) {
+    const RowSpan& span = request.spans[i];
+    tft.drawRGBBitmap(0, span.y, pixels + (span.y - request.originY) * SCREEN_WIDTH,
+                      SCREEN_WIDTH, span.height);
+  }
+}
+#endif
+
+#if DISPLAY_ASYNC_BLIT
+// The Adafruit driver has no DMA path on the ESP32, so transfers run on
+// a task on the other core instead; the loop keeps rendering meanwhile.
+static QueueHandle_t blitQueue = nullptr;
+static SemaphoreHandle_t bufferFree[DISPLAY_BUFFERS];
+static volatile uint32_t transferEndMicros[DISPLAY_BUFFERS];
+
+static void blitTask(void*) {
+  BlitRequest request;
+  while (true) {
+    xQueueReceive(blitQueue, &request, portMAX_DELAY);
+    sendSpans(request);
+    transferEndMicros[request.buffer] = micros();
+    xSemaphoreGive(bufferFree[request.buffer]);
+  }
+}
+
+// Wait for a buffer's transfer and take ownership of it
+static void acquireBuffer(int buffer) {
+  xSemaphoreTake(bufferFree[buffer], portMAX_DELAY);
+  latencyTrace.completeFrame(buffer, transferEndMicros[buffer]);
+}
+#endif
 
 void Display::init() {
   Serial.println("Initializing ST7735S display...");
@@ -11,33 +98,95 @@ void Display::init() {
   tft.setRotation(0);
   tft.fillScreen(ST77XX_BLACK);
 
+#if DISPLAY_ASYNC_BLIT
+  blitQueue = xQueueCreate(DISPLAY_BUFFERS, sizeof(BlitRequest));
+  for (int i = 0; i < DISPLAY_BUFFERS; i++) {
+    bufferFree[i] = xSemaphoreCreateBinary();
+    xSemaphoreGive(bufferFree[i]);
+  }
+  xTaskCreatePinnedToCore(blitTask, "blit", 4096, nullptr,
+                          BLIT_TASK_PRIORITY, nullptr, BLIT_TASK_CORE);
+#endif
+
   Serial.println("ST7735S display initialized");
 }
 
 Adafruit_ST7735& Display::getTft() {
+  waitForBlit();
   return tft;
 }
 
-GFXcanvas16& Display::getCanvas() {
-  return canvas;
+void Display::render(SceneFunction scene) {
+  // The same indices mean different colors under a new palette
+  if (DISPLAY_INDEXED_COLOR && drawPalette != sentPalette) frameDiff.invalidate();
+  sentPalette = drawPalette;
+
+  uint32_t frameBytes = 0;
+  for (int y = 0; y < SCREEN_HEIGHT; y += DISPLAY_STRIP_ROWS) {
+#if DISPLAY_ASYNC_BLIT
+    acquireBuffer(drawIndex);  // The fence
+#endif
+    FrameCanvas& strip = *strips[drawIndex];
+    strip.setOriginY(y);
+    scene(strip);
+
+    BlitRequest request;
+    request.buffer = drawIndex;
+    request.originY = y;
+    request.palette = drawPalette->colors;
+    request.spanCount = frameDiff.diff(strip.getBuffer(), y, DISPLAY_STRIP_ROWS,
+                                       request.spans, BLIT_MAX_SPANS);
+    frameBytes += FrameDiff::transferBytes(request.spans, request.spanCount);
+
+    // The frame's latency runs from its first strip's submission to the
+    // end of its last strip's transfer
+    if (y == 0) latencyTrace.mark(LATENCY_BLIT_START);
+    bool lastStrip = y + DISPLAY_STRIP_ROWS >= SCREEN_HEIGHT;
+    if (lastStrip) latencyTrace.submitFrame(drawIndex);
+
+#if DISPLAY_ASYNC_BLIT
+    // Queued even without changed rows, so strips complete in order
+    xQueueSend(blitQueue, &request, portMAX_DELAY);
+#else
+    sendSpans(request);
+    if (lastStrip) latencyTrace.completeFrame(drawIndex, micros());
+#endif
+
+    // Draw the next strip into the other buffer
+    drawIndex = (drawIndex + 1) % DISPLAY_BUFFERS;
+  }
+  blitStats.add(frameBytes);
 }
 
-void Display::blit() {
-  tft.drawRGBBitmap(0, 0, canvas.getBuffer(), SCREEN_WIDTH, SCREEN_HEIGHT);
+void Display::waitForBlit() {
+#if DISPLAY_ASYNC_BLIT
+  for (int i = 0; i < DISPLAY_BUFFERS; i++) {
+    acquireBuffer(i);
+    xSemaphoreGive(bufferFree[i]);
+  }
+#endif
+}
+
+void Display::setPalette(const Palette& palette) {
+  drawPalette = &palette;
+}
+
+const BlitStats& Display::getBlitStats() const {
+  return blitStats;
 }
 
 void Display::clear() {
+  waitForBlit();
   tft.fillScreen(ST77XX_BLACK);
+  frameDiff.invalidate();
 }
 
 void Display::showMessage(const char* message, uint16_t color) {
+  waitForBlit();
   tft.fillScreen(ST77XX_BLACK);
   tft.setCursor(10, 60);
   tft.setTextColor(color);
   tft.setTextSize(1);
   tft.println(message);
-}
-
-uint16_t Display::rgb565(uint8_t r, uint8_t g, uint8_t b) {
-  return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+  frameDiff.invalidate();
 }
@@ -1,36 +1,61 @@
 #ifndef DISPLAY_H
 #define DISPLAY_H
 
-// Both platforms use Adafruit GFX canvas
+// Both platforms draw into Adafruit GFX canvases
 #include <Adafruit_GFX.h>
 #ifndef SIMULATOR
   #include <Adafruit_ST7735.h>
 #endif
+#include "FrameCanvas.h"
+#include "FrameDiff.h"
+#include "Palette.h"
 
-using Canvas = GFXcanvas16;
+// Draws a whole frame in screen coordinates into the given strip
+typedef void (*SceneFunction)(FrameCanvas& canvas);
 
 class Display {
 public:
   // Initialize display
   void init();
 
-  // Get reference to canvas for double-buffered drawing
-  Canvas& getCanvas();
+  // Render a frame strip by strip (DISPLAY_STRIP_ROWS rows each): the
+  // scene runs once per strip, clipped to its rows, and the strip's
+  // changed rows go to the panel while the next strip is drawn. Each
+  // strip first waits until its buffer's previous transfer has finished
+  // (the fence). With DISPLAY_ASYNC_BLIT this returns once the last
+  // strip is queued.
+  void render(SceneFunction scene);
 
-  // Blit canvas to display
-  void blit();
+  // Wait until every submitted strip has reached the panel
+  void waitForBlit();
+
+  // Colors the next frame's pixel values index. Kept with each strip
+  // until its transfer expands it to RGB565; ignored with 16-bit canvases.
+  // The palette must outlive the transfer (modes use static tables).
+  void setPalette(const Palette& palette);
+
+  // Bytes sent per frame versus full-frame transfers
+  const BlitStats& getBlitStats() const;
 
   // Clear screen to black
   void clear();
 
-  // Show a message centered on screen
+  // Show a message centered on screen (color is RGB565)
   void showMessage(const char* message, uint16_t color);
 
-  // Convert RGB to 565 format
-  static uint16_t rgb565(uint8_t r, uint8_t g, uint8_t b);
+  // Convert RGB to 565 format (usable in constant expressions)
+  static constexpr uint16_t rgb565(uint8_t r, uint8_t g, uint8_t b) {
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+  }
+
+#ifdef HEADLESS
+  // Headless only: the panel image (RGB565, row by row) once the last
+  // render() has been sent
+  const uint16_t* getPanel() const;
+#endif
 
 #ifndef SIMULATOR
-  // ESP32 only: Get reference to TFT for direct drawing
+  // ESP32 only: Get reference to TFT for direct drawing (waits for blits)
   Adafruit_ST7735& getTft();
 #endif
 };
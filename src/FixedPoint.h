@@ -0,0 +1,63 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+// Signed Q16.16 fixed-point number: 16 integer bits, 16 fractional bits.
+// Range is about +/-32768 with a resolution of 1/65536 (~0.000015), plenty
+// for pressure deltas in Pa and normalized values in [-1, 1]. Floats
+// outside the range saturate (NaN converts to 0); arithmetic does not.
+class Q16 {
+public:
+  static constexpr int FRACTION_BITS = 16;
+  static constexpr int32_t ONE = 1 << FRACTION_BITS;
+
+  constexpr Q16() : raw(0) {}
+  constexpr explicit Q16(float value) : raw(saturate(value)) {}
+  constexpr explicit Q16(int value) : raw(value * ONE) {}
+
+  static constexpr Q16 fromRaw(int32_t value) { Q16 q; q.raw = value; return q; }
+  constexpr int32_t toRaw() const { return raw; }
+  constexpr float toFloat() const { return (float)raw / ONE; }
+
+  constexpr Q16 operator-() const { return fromRaw(-raw); }
+  constexpr Q16 operator+(Q16 o) const { return fromRaw(raw + o.raw); }
+  constexpr Q16 operator-(Q16 o) const { return fromRaw(raw - o.raw); }
+  constexpr Q16 operator*(Q16 o) const {
+    return fromRaw((int32_t)(((int64_t)raw * o.raw) >> FRACTION_BITS));
+  }
+  constexpr Q16 operator/(Q16 o) const {
+    return fromRaw((int32_t)(((int64_t)raw << FRACTION_BITS) / o.raw));
+  }
+
+  Q16& operator+=(Q16 o) { raw += o.raw; return *this; }
+  Q16& operator-=(Q16 o) { raw -= o.raw; return *this; }
+  Q16& operator*=(Q16 o) { return *this = *this * o; }
+
+  constexpr bool operator<(Q16 o) const { return raw < o.raw; }
+  constexpr bool operator>(Q16 o) const { return raw > o.raw; }
+  constexpr bool operator<=(Q16 o) const { return raw <= o.raw; }
+  constexpr bool operator>=(Q16 o) const { return raw >= o.raw; }
+  constexpr bool operator==(Q16 o) const { return raw == o.raw; }
+  constexpr bool operator!=(Q16 o) const { return raw != o.raw; }
+
+private:
+  // Largest magnitude, kept symmetric so negation cannot overflow
+  static constexpr int32_t MAX_RAW = INT32_MAX;
+  static constexpr float LIMIT = 32768.0f;
+
+  static constexpr int32_t saturate(float value) {
+    return value >= LIMIT ? MAX_RAW
+         : value <= -LIMIT ? -MAX_RAW
+         : value != value ? 0
+         : (int32_t)(value * ONE + (value >= 0 ? 0.5f : -0.5f));
+  }
+
+  int32_t raw;
+};
+
+// Uniform conversions so templates can work on float or Q16 samples
+inline constexpr float toFloat(float value) { return value; }
+inline constexpr float toFloat(Q16 value) { return value.toFloat(); }
+
+#endif // FIXED_POINT_H
@@ -0,0 +1,29 @@
+#include "FrameCanvas.h"
+#include "Raster.h"
+
+FrameCanvas::FrameCanvas(int16_t rows) : Canvas(SCREEN_WIDTH, rows) {
+  // Clip text and shapes against the whole screen, not the strip
+  _height = SCREEN_HEIGHT;
+}
+
+void FrameCanvas::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  y -= originY;
+  if (x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) return;
+  getBuffer()[y * WIDTH + x] = color;
+}
+
+void FrameCanvas::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  if (w < 0) {
+    x += w + 1;
+    w = -w;
+  }
+  Raster(*this).fillRow(y, x, x + w, color);
+}
+
+void FrameCanvas::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  if (h < 0) {
+    y += h + 1;
+    h = -h;
+  }
+  Raster(*this).fillColumn(x, y, y + h, color);
+}
@@ -0,0 +1,44 @@
+#ifndef FRAME_CANVAS_H
+#define FRAME_CANVAS_H
+
+#include <Adafruit_GFX.h>
+#include "config.h"
+#include "Palette.h"
+
+// Canvas the strips are built on: palette indices or RGB565 (Palette.h)
+#if DISPLAY_INDEXED_COLOR
+using Canvas = GFXcanvas8;
+#else
+using Canvas = GFXcanvas16;
+#endif
+
+// One horizontal strip of the frame, drawn in screen coordinates. The
+// buffer holds only getRows() rows starting at the origin and anything
+// outside them is clipped, so a scene can draw the whole screen into
+// each strip in turn. To Adafruit_GFX the canvas is the full screen,
+// so text wraps and clips as it would on a whole-frame canvas.
+class FrameCanvas : public Canvas {
+public:
+  explicit FrameCanvas(int16_t rows);
+
+  // First screen row held in the buffer
+  void setOriginY(int16_t y) { originY = y; }
+  int16_t getOriginY() const { return originY; }
+
+  // Rows held in the buffer
+  int16_t getRows() const { return HEIGHT; }
+
+  // Whether any of screen rows [y0, y1) fall inside the strip
+  bool holdsRows(int y0, int y1) const { return y0 < originY + HEIGHT && y1 > originY; }
+
+  // Translated to the strip and clipped (fillRect, text and shapes
+  // reach the buffer through these)
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+
+private:
+  int16_t originY = 0;
+};
+
+#endif // FRAME_CANVAS_H
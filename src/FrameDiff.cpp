@@ -0,0 +1,61 @@
+#include "FrameDiff.h"
+#include <string.h>
+
+// CASET + RASET + RAMWR: 3 command bytes and 8 address bytes
+static const uint32_t WINDOW_OVERHEAD_BYTES = 11;
+
+// FNV-1a over 32-bit words (two RGB565 pixels or four palette indices)
+static uint32_t hashRow(const Pixel* row) {
+  static const int ROW_WORDS = SCREEN_WIDTH * sizeof(Pixel) / sizeof(uint32_t);
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < ROW_WORDS; i++) {
+    uint32_t word;
+    memcpy(&word, (const uint8_t*)row + i * sizeof(uint32_t), sizeof(word));
+    hash = (hash ^ word) * 16777619u;
+  }
+  return hash;
+}
+
+int FrameDiff::diff(const Pixel* rows, int firstRow, int rowCount, RowSpan* spans, int maxSpans) {
+  int count = 0;
+  int gap = 0;
+  for (int y = firstRow; y < firstRow + rowCount; y++) {
+    uint32_t hash = hashRow(rows + (y - firstRow) * SCREEN_WIDTH);
+    bool dirty = !valid || hash != rowHashes[y];
+    rowHashes[y] = hash;
+
+    if (!dirty) {
+      gap++;
+      continue;
+    }
+
+    if (count > 0 && gap <= BLIT_MERGE_GAP_ROWS) {
+      // Extend the previous span over the clean gap
+      spans[count - 1].height = y + 1 - spans[count - 1].y;
+    } else if (count < maxSpans) {
+      spans[count].y = y;
+      spans[count].height = 1;
+      count++;
+    } else {
+      // Out of spans: the last one runs to this row
+      spans[count - 1].height = y + 1 - spans[count - 1].y;
+    }
+    gap = 0;
+  }
+
+  // Every row has a hash once the last strip is in
+  if (firstRow + rowCount >= SCREEN_HEIGHT) valid = true;
+  return count;
+}
+
+uint32_t FrameDiff::fullFrameBytes() {
+  return WINDOW_OVERHEAD_BYTES + SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint16_t);
+}
+
+uint32_t FrameDiff::transferBytes(const RowSpan* spans, int count) {
+  uint32_t bytes = 0;
+  for (int i = 0; i < count; i++) {
+    bytes += WINDOW_OVERHEAD_BYTES + spans[i].height * SCREEN_WIDTH * sizeof(uint16_t);
+  }
+  return bytes;
+}
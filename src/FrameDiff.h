@@ -0,0 +1,57 @@
+#ifndef FRAME_DIFF_H
+#define FRAME_DIFF_H
+
+#include <stdint.h>
+#include "config.h"
+#include "Palette.h"
+
+// Rows [y, y + height) that changed since the last transmitted frame
+struct RowSpan {
+  int16_t y;
+  int16_t height;
+};
+
+// Finds the rows of a frame that differ from the last one sent, using a
+// 32-bit hash per row instead of a shadow copy of the frame (512 bytes
+// rather than 16-32 KB). Nearby dirty rows are merged into one span when
+// the gap is cheaper to resend than a new address window.
+class FrameDiff {
+public:
+  // Forget the panel contents (e.g. after drawing directly to it)
+  void invalidate() { valid = false; }
+
+  // Compare rows [firstRow, firstRow + rowCount) of the frame (rows
+  // points at firstRow) against the stored hashes, store the new ones
+  // and write up to maxSpans (at least 1) spans. Returns the number of
+  // spans; when they run out the last span is extended instead. Strips
+  // of a frame are passed top to bottom.
+  int diff(const Pixel* rows, int firstRow, int rowCount, RowSpan* spans, int maxSpans);
+
+  // Bytes an ST7735 (RGB565) transfer of the spans costs, including the
+  // column/row/memory-write commands for each address window
+  static uint32_t transferBytes(const RowSpan* spans, int count);
+
+  // Bytes a full-frame transfer costs
+  static uint32_t fullFrameBytes();
+
+private:
+  uint32_t rowHashes[SCREEN_HEIGHT];
+  bool valid = false;
+};
+
+// Per-frame transfer accounting
+struct BlitStats {
+  unsigned long frames = 0;
+  uint64_t fullFrameBytes = 0;  // What full-frame blits would have sent
+  uint64_t sentBytes = 0;
+  uint32_t lastFrameBytes = 0;
+
+  void add(uint32_t bytes) {
+    frames++;
+    fullFrameBytes += FrameDiff::fullFrameBytes();
+    sentBytes += bytes;
+    lastFrameBytes = bytes;
+  }
+};
+
+#endif // FRAME_DIFF_H
@@ -0,0 +1,115 @@
+#include "HudText.h"
+#include "NumberFormat.h"
+
+// ========================================
+// GlyphAtlas
+// ========================================
+
+void GlyphAtlas::init() {
+  // One cell, drawn and read back per character
+  GFXcanvas1 cell(GLYPH_ADVANCE, GLYPH_HEIGHT);
+  for (int c = GLYPH_FIRST; c <= GLYPH_LAST; c++) {
+    cell.fillScreen(0);
+    cell.drawChar(0, 0, c, 1, 0, 1, 1);
+    for (int y = 0; y < GLYPH_HEIGHT; y++) {
+      uint8_t mask = 0;
+      for (int x = 0; x < GLYPH_ADVANCE - 1; x++) {
+        if (cell.getPixel(x, y)) mask |= 1 << x;
+      }
+      rows[c - GLYPH_FIRST][y] = mask;
+    }
+  }
+
+  for (int mask = 0; mask < 32; mask++) {
+    GlyphRuns& r = runs[mask];
+    r.count = 0;
+    for (int x = 0; x < GLYPH_ADVANCE - 1; x++) {
+      if (!(mask & (1 << x))) continue;
+      if (x > 0 && (mask & (1 << (x - 1)))) {
+        r.length[r.count - 1]++;
+      } else {
+        r.start[r.count] = x;
+        r.length[r.count] = 1;
+        r.count++;
+      }
+    }
+  }
+
+  ready = true;
+}
+
+// ========================================
+// HudText
+// ========================================
+
+HudText::HudText(FrameCanvas& canvas) : canvas(canvas), raster(canvas) {}
+
+void HudText::print(const char* text) {
+  while (*text) write(*text++);
+}
+
+void HudText::print(int value) {
+  char text[NUMBER_TEXT_SIZE];
+  formatInt(text, value);
+  print(text);
+}
+
+void HudText::print(float value, int digits) {
+  char text[NUMBER_TEXT_SIZE];
+  formatFloat(text, value, digits);
+  print(text);
+}
+
+void HudText::println(const char* text) {
+  print(text);
+  write('\n');
+}
+
+void HudText::write(char c) {
+  if (c == '\n') {
+    cursorX = 0;
+    cursorY += textSize * GLYPH_HEIGHT;
+    return;
+  }
+  if (c == '\r') return;
+
+  // Wrap like the canvas does
+  if (cursorX + textSize * GLYPH_ADVANCE > canvas.width()) {
+    cursorX = 0;
+    cursorY += textSize * GLYPH_HEIGHT;
+  }
+  drawGlyph(cursorX, cursorY, (unsigned char)c);
+  cursorX += textSize * GLYPH_ADVANCE;
+}
+
+void HudText::drawGlyph(int x, int y, unsigned char c) {
+  const uint8_t* rows = glyphAtlas.isReady() ? glyphAtlas.getRows(c) : nullptr;
+  if (!rows) {
+    canvas.drawChar(x, y, c, textColor, background, textSize, textSize);
+    return;
+  }
+
+  int cellWidth = textSize * GLYPH_ADVANCE;
+  int cellHeight = textSize * GLYPH_HEIGHT;
+  if (x >= canvas.width() || x + cellWidth <= 0 || !canvas.holdsRows(y, y + cellHeight)) {
+    return;
+  }
+
+  if (background != textColor) {
+    raster.fillRect(x, y, cellWidth, cellHeight, background);
+  }
+
+  for (int row = 0; row < GLYPH_HEIGHT; row++) {
+    const GlyphRuns& runs = glyphAtlas.getRuns(rows[row]);
+    int rowY = y + row * textSize;
+    for (int i = 0; i < runs.count; i++) {
+      int runX = x + runs.start[i] * textSize;
+      int runWidth = runs.length[i] * textSize;
+      if (textSize == 1) {
+        raster.fillRow(rowY, runX, runX + runWidth, textColor);
+      } else {
+        raster.fillRect(runX, rowY, runWidth, textSize, textColor);
+      }
+    }
+  }
+}
@@ -0,0 +1,92 @@
+#ifndef HUD_TEXT_H
+#define HUD_TEXT_H
+
+#include <stdint.h>
+#include "FrameCanvas.h"
+#include "Raster.h"
+
+// Characters kept in the atlas (printable ASCII); others fall back to
+// Adafruit_GFX::drawChar()
+#define GLYPH_FIRST   ' '
+#define GLYPH_LAST    '~'
+#define GLYPH_COUNT   (GLYPH_LAST - GLYPH_FIRST + 1)
+#define GLYPH_HEIGHT  8   // Built-in font rows, including the descender
+#define GLYPH_ADVANCE 6   // 5 columns plus one column of spacing
+
+// Horizontal runs of set pixels in one 5-pixel glyph row
+struct GlyphRuns {
+  uint8_t count;
+  uint8_t start[3];
+  uint8_t length[3];
+};
+
+// The Adafruit GFX built-in 5x8 font, rasterized once at boot into row
+// bitmasks (760 bytes), plus the runs of every possible row. Drawing a
+// glyph is then a handful of span fills per row at any text size.
+class GlyphAtlas {
+public:
+  // Rasterize the font through a small GFXcanvas1
+  void init();
+
+  bool isReady() const { return ready; }
+
+  // GLYPH_HEIGHT row masks (bit i = column i), or nullptr when c is
+  // not in the atlas
+  const uint8_t* getRows(unsigned char c) const {
+    if (c < GLYPH_FIRST || c > GLYPH_LAST) return nullptr;
+    return rows[c - GLYPH_FIRST];
+  }
+
+  // Runs of one row mask
+  const GlyphRuns& getRuns(uint8_t rowMask) const { return runs[rowMask & 0x1F]; }
+
+private:
+  uint8_t rows[GLYPH_COUNT][GLYPH_HEIGHT];
+  GlyphRuns runs[32];
+  bool ready = false;
+};
+
+// Global glyph atlas (defined in main.cpp)
+extern GlyphAtlas glyphAtlas;
+
+// HUD text drawn from the glyph atlas. Cursor, color, size and wrapping
+// behave like the canvas text calls it replaces, and the pixels are the
+// same; numbers are formatted without snprintf (NumberFormat). Colors
+// are canvas pixel values (palette indices with DISPLAY_INDEXED_COLOR).
+// Glyphs outside the canvas strip are skipped.
+class HudText {
+public:
+  explicit HudText(FrameCanvas& canvas);
+
+  void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+
+  // Transparent background
+  void setTextColor(Pixel color) { textColor = background = color; }
+
+  // Opaque background
+  void setTextColor(Pixel color, Pixel bg) { textColor = color; background = bg; }
+
+  void setTextSize(uint8_t size) { textSize = size ? size : 1; }
+
+  void print(const char* text);
+  void print(int value);
+  void print(float value, int digits = 2);
+  void println(const char* text = "");
+
+  int16_t getCursorX() const { return cursorX; }
+  int16_t getCursorY() const { return cursorY; }
+
+private:
+  void write(char c);
+  void drawGlyph(int x, int y, unsigned char c);
+
+  FrameCanvas& canvas;
+  Raster raster;
+  int16_t cursorX = 0;
+  int16_t cursorY = 0;
+  Pixel textColor = 0;
+  Pixel background = 0;
+  uint8_t textSize = 1;
+};
+
+#endif // HUD_TEXT_H
@@ -0,0 +1,117 @@
+#include "LatencyTrace.h"
+#include <string.h>
+
+static const char* const stageNames[LATENCY_STAGE_COUNT] = {
+  "read", "detect", "render", "blit start", "blit end"
+};
+
+void LatencyTrace::reset() {
+  memset(histograms, 0, sizeof(histograms));
+  memset(marks, 0, sizeof(marks));
+  memset(pending, 0, sizeof(pending));
+  haveSample = false;
+  rendering = false;
+  frames = 0;
+  flashStalls.store(0);
+  maxFlashStallMicros.store(0);
+}
+
+void LatencyTrace::noteFlashStall(uint32_t stallMicros) {
+  flashStalls.fetch_add(1);
+  if (stallMicros > maxFlashStallMicros.load()) maxFlashStallMicros.store(stallMicros);
+}
+
+void LatencyTrace::noteSample(uint32_t capture, uint32_t readMicros, uint32_t detectMicros) {
+  captureMicros = capture;
+  marks[LATENCY_READ] = capture + readMicros;
+  marks[LATENCY_DETECT] = detectMicros;
+  haveSample = true;
+}
+
+void LatencyTrace::mark(LatencyStage stage) {
+  marks[stage] = micros();
+  if (stage == LATENCY_RENDER) rendering = true;
+}
+
+void LatencyTrace::submitFrame(int slot) {
+  // Only frames drawn by a mode after a sample arrived
+  pending[slot].active = rendering && haveSample;
+  if (!pending[slot].active) return;
+  rendering = false;
+
+  memcpy(pending[slot].marks, marks, sizeof(marks));
+  pending[slot].captureMicros = captureMicros;
+}
+
+void LatencyTrace::completeFrame(int slot, uint32_t endMicros) {
+  PendingFrame& frame = pending[slot];
+  if (!frame.active) return;
+  frame.active = false;
+
+  frame.marks[LATENCY_BLIT_END] = endMicros;
+  for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+    record((LatencyStage)stage, frame.marks[stage] - frame.captureMicros);
+  }
+  frames++;
+}
+
+void LatencyTrace::record(LatencyStage stage, uint32_t latencyMicros) {
+  int bucket = 0;
+  while (bucket < LATENCY_BUCKETS - 1 && (latencyMicros >> (bucket + 1)) != 0) {
+    bucket++;
+  }
+
+  Histogram& histogram = histograms[stage];
+  histogram.buckets[bucket]++;
+  histogram.count++;
+  histogram.sumMicros += latencyMicros;
+  if (latencyMicros > histogram.maxMicros) histogram.maxMicros = latencyMicros;
+}
+
+// Upper edge (us) of the bucket holding the given fraction of samples
+static uint32_t percentileMicros(const uint32_t* buckets, uint32_t count, float fraction) {
+  uint32_t target = (uint32_t)(count * fraction);
+  uint32_t seen = 0;
+  for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+    seen += buckets[bucket];
+    if (seen > target) return 2UL << bucket;
+  }
+  return 2UL << (LATENCY_BUCKETS - 1);
+}
+
+void LatencyTrace::report() const {
+  Serial.print("Latency from sample capture (");
+  Serial.print((int)frames);
+  Serial.println(" frames, ms)");
+  Serial.print("Flash stalls: ");
+  Serial.print((int)flashStalls.load());
+  Serial.print(", max ");
+  Serial.print(maxFlashStallMicros.load() / 1000.0f, 2);
+  Serial.println(" ms (sampling and detection wait too)");
+  if (frames == 0) return;
+
+  Serial.println("Stage       Mean  P50<  P99<  Max");
+  for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+    const Histogram& histogram = histograms[stage];
+    Serial.print(stageNames[stage]);
+    for (int pad = strlen(stageNames[stage]); pad < 12; pad++) Serial.print(" ");
+    Serial.print((float)(histogram.sumMicros / histogram.count) / 1000.0f, 2);
+    Serial.print("  ");
+    Serial.print(percentileMicros(histogram.buckets, histogram.count, 0.5f) / 1000.0f, 2);
+    Serial.print("  ");
+    Serial.print(percentileMicros(histogram.buckets, histogram.count, 0.99f) / 1000.0f, 2);
+    Serial.print("  ");
+    Serial.println(histogram.maxMicros / 1000.0f, 2);
+  }
+
+  // Full distribution of the photon latency
+  const Histogram& photon = histograms[LATENCY_BLIT_END];
+  Serial.println("Blit end histogram (bucket upper edge ms: frames)");
+  for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+    if (photon.buckets[bucket] == 0) continue;
+    Serial.print("  <");
+    Serial.print((2UL << bucket) / 1000.0f, 3);
+    Serial.print(": ");
+    Serial.println((int)photon.buckets[bucket]);
+  }
+}
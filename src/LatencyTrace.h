@@ -0,0 +1,90 @@
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <atomic>
+#include <stdint.h>
+#include "config.h"
+
+// Points along the path from a sensor read to the panel. Each is
+// measured from the capture time of the newest sample in the frame.
+enum LatencyStage {
+  LATENCY_READ,         // Sensor read finished
+  LATENCY_DETECT,       // Breath detection ran on the sample
+  LATENCY_RENDER,       // Mode started drawing
+  LATENCY_BLIT_START,   // First strip handed to the blit
+  LATENCY_BLIT_END,     // Last strip transfer finished (photon)
+  LATENCY_STAGE_COUNT
+};
+
+// Histogram buckets: bucket i counts latencies in [2^i, 2^(i+1)) us
+#define LATENCY_BUCKETS 24
+
+// Sensor-to-photon latency per stage, collected as log2 histograms.
+// The render task notes the newest sample in the breath snapshot, stages
+// are marked as the frame progresses, and the frame is recorded when its transfer ends
+// (which may be after the next frame has started with async blits).
+// Frames that are never blitted (FPS gate) are not counted.
+class LatencyTrace {
+public:
+  void reset();
+
+  // Newest sample in the breath snapshot the frame is drawn from:
+  // capture time, read duration and when detection finished with it
+  void noteSample(uint32_t captureMicros, uint32_t readMicros, uint32_t detectMicros);
+
+  // Timestamp a stage of the frame in progress
+  void mark(LatencyStage stage);
+
+  // Last strip of the frame, in display buffer slot, was handed to the
+  // blit (after LATENCY_BLIT_START was marked for its first strip): keep
+  // the frame's stages until that transfer completes
+  void submitFrame(int slot);
+
+  // Transfer of the strip in slot finished: if it ended a frame, add the
+  // frame to the histograms
+  void completeFrame(int slot, uint32_t endMicros);
+
+  unsigned long getFrameCount() const { return frames; }
+
+  // Storage task: a flash write or erase took this long. On the ESP32
+  // both cores stop running from flash meanwhile, so sampling, detection
+  // and rendering all stall for it.
+  void noteFlashStall(uint32_t stallMicros);
+
+  // Print a summary and histogram per stage over Serial
+  void report() const;
+
+private:
+  struct Histogram {
+    uint32_t buckets[LATENCY_BUCKETS];
+    uint32_t count;
+    uint64_t sumMicros;
+    uint32_t maxMicros;
+  };
+
+  void record(LatencyStage stage, uint32_t latencyMicros);
+
+  // Submitted frames waiting for their transfer to finish, per buffer
+  struct PendingFrame {
+    uint32_t marks[LATENCY_STAGE_COUNT];
+    uint32_t captureMicros;
+    bool active;
+  };
+
+  Histogram histograms[LATENCY_STAGE_COUNT];
+  PendingFrame pending[DISPLAY_BUFFERS];
+  uint32_t marks[LATENCY_STAGE_COUNT];
+  uint32_t captureMicros = 0;
+  bool haveSample = false;
+  bool rendering = false;
+  unsigned long frames = 0;
+
+  // Written by the storage task
+  std::atomic<uint32_t> flashStalls{0};
+  std::atomic<uint32_t> maxFlashStallMicros{0};
+};
+
+// Global latency trace (defined in main.cpp)
+extern LatencyTrace latencyTrace;
+
+#endif // LATENCY_TRACE_H
@@ -0,0 +1,71 @@
+#include "NumberFormat.h"
+#include <math.h>
+#include <string.h>
+
+// Powers of ten for the fraction digits
+static const uint32_t powersOfTen[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+static const int MAX_FRACTION_DIGITS = 6;
+
+// Largest value Arduino prints in full (a larger float overflows its unsigned long)
+static const float MAX_FORMATTED = 4294967040.0f;
+
+// Append value as exactly width digits (zero padded), or as many as
+// it needs when width is 0. Returns the digits written.
+static size_t appendUnsigned(char* out, uint32_t value, int width) {
+  char digits[10];
+  int count = 0;
+  do {
+    digits[count++] = '0' + value % 10;
+    value /= 10;
+  } while (value > 0 && count < 10);
+  while (count < width) digits[count++] = '0';
+
+  for (int i = 0; i < count; i++) {
+    out[i] = digits[count - 1 - i];
+  }
+  return count;
+}
+
+size_t formatInt(char* out, long value) {
+  size_t length = 0;
+  uint32_t magnitude = (uint32_t)value;
+  if (value < 0) {
+    out[length++] = '-';
+    magnitude = 0u - magnitude;
+  }
+  length += appendUnsigned(out + length, magnitude, 0);
+  out[length] = '\0';
+  return length;
+}
+
+size_t formatFloat(char* out, float value, int digits) {
+  if (isnan(value)) { strcpy(out, "nan"); return 3; }
+  if (isinf(value)) { strcpy(out, "inf"); return 3; }
+  if (value > MAX_FORMATTED || value < -MAX_FORMATTED) { strcpy(out, "ovf"); return 3; }
+
+  if (digits < 0) digits = 0;
+  if (digits > MAX_FRACTION_DIGITS) digits = MAX_FRACTION_DIGITS;
+
+  size_t length = 0;
+  if (value < 0) {
+    out[length++] = '-';
+    value = -value;
+  }
+
+  // Split before scaling so large values keep their fraction digits
+  uint32_t scale = powersOfTen[digits];
+  uint32_t integer = (uint32_t)value;
+  uint32_t fraction = (uint32_t)((value - integer) * scale + 0.5f);
+  if (fraction >= scale) {
+    integer++;
+    fraction -= scale;
+  }
+
+  length += appendUnsigned(out + length, integer, 0);
+  if (digits > 0) {
+    out[length++] = '.';
+    length += appendUnsigned(out + length, fraction, digits);
+  }
+  out[length] = '\0';
+  return length;
+}
@@ -0,0 +1,22 @@
+#ifndef NUMBER_FORMAT_H
+#define NUMBER_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Buffer size that fits any formatInt()/formatFloat() result
+#define NUMBER_TEXT_SIZE 20
+
+// Decimal text for HUD numbers without snprintf or the heap. Both write
+// a terminated string into out (NUMBER_TEXT_SIZE bytes) and return its
+// length.
+size_t formatInt(char* out, long value);
+
+// Fixed-point text with 0-6 digits after the point, rounded half away
+// from zero like Arduino's Print::print(double, digits), including its
+// "nan", "inf" and "ovf" results. The fraction is scaled and rounded
+// in single precision, so it can round the last digit differently from
+// printf for values within float precision of a tie.
+size_t formatFloat(char* out, float value, int digits);
+
+#endif // NUMBER_FORMAT_H
@@ -0,0 +1,48 @@
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include <stdint.h>
+#include "config.h"
+
+#define PALETTE_SIZE 256
+
+// What the canvas stores per pixel: a palette index when
+// DISPLAY_INDEXED_COLOR is set, otherwise the RGB565 color itself
+#if DISPLAY_INDEXED_COLOR
+using Pixel = uint8_t;
+#else
+using Pixel = uint16_t;
+#endif
+
+// RGB565 colors of one mode, indexed by the 8-bit canvas. Modes build
+// theirs in constant expressions with add(), together with the pixel
+// values they draw with, and hand it to Display::setPalette().
+struct Palette {
+  uint16_t colors[PALETTE_SIZE] = {};
+  int count = 0;
+  bool overflow = false;  // More than PALETTE_SIZE colors were added
+
+  // Index of an RGB565 color, appending it the first time
+  constexpr uint8_t add(uint16_t rgb) {
+    for (int i = 0; i < count; i++) {
+      if (colors[i] == rgb) return i;
+    }
+    if (count == PALETTE_SIZE) {
+      overflow = true;
+      return 0;
+    }
+    colors[count] = rgb;
+    return count++;
+  }
+
+  // Canvas value for an RGB565 color
+  constexpr Pixel pixel(uint16_t rgb) {
+#if DISPLAY_INDEXED_COLOR
+    return add(rgb);
+#else
+    return rgb;
+#endif
+  }
+};
+
+#endif // PALETTE_H
@@ -0,0 +1,122 @@
+#include "PressureFilter.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+  #define M_PI 3.14159265358979323846
+#endif
+
+Biquad designLowpassBiquad(float cutoffHz, float sampleRateHz, float q) {
+  float w0 = 2.0f * (float)M_PI * cutoffHz / sampleRateHz;
+  float cosW0 = cosf(w0);
+  float alpha = sinf(w0) / (2.0f * q);
+  float a0 = 1.0f + alpha;
+
+  Biquad section;
+  section.b0 = (1.0f - cosW0) * 0.5f / a0;
+  section.b1 = (1.0f - cosW0) / a0;
+  section.b2 = section.b0;
+  section.a1 = -2.0f * cosW0 / a0;
+  section.a2 = (1.0f - alpha) / a0;
+  return section;
+}
+
+void PressureFilter::init(float rateHz) {
+  sampleRateHz = rateHz;
+
+  // Butterworth pole pairs: Q = 1 / (2 cos(theta)) for each section
+  const int order = 2 * FILTER_BIQUAD_SECTIONS;
+  float cutoff = FILTER_CUTOFF_HZ;
+  if (cutoff > 0.45f * sampleRateHz) cutoff = 0.45f * sampleRateHz;
+  float biquadDelay = 0;
+  for (int s = 0; s < FILTER_BIQUAD_SECTIONS; s++) {
+    float theta = (float)M_PI * (2 * s + 1) / (2.0f * order);
+    float q = 1.0f / (2.0f * cosf(theta));
+    sections[s] = designLowpassBiquad(cutoff, sampleRateHz, q);
+
+    // Low-frequency group delay of a 2nd-order low-pass is 1 / (Q * w0)
+    biquadDelay += 1.0f / (q * 2.0f * (float)M_PI * cutoff);
+  }
+
+  // Hamming-windowed sinc, normalized to unity gain at DC
+  const int center = (FILTER_FIR_TAPS - 1) / 2;
+  float fc = FILTER_FIR_CUTOFF_HZ / sampleRateHz;
+  if (fc > 0.45f) fc = 0.45f;
+  float sum = 0;
+  for (int i = 0; i < FILTER_FIR_TAPS; i++) {
+    float x = (float)(i - center);
+    float sinc = (i == center) ? 2.0f * fc : sinf(2.0f * (float)M_PI * fc * x) / ((float)M_PI * x);
+    float window = 0.54f - 0.46f * cosf(2.0f * (float)M_PI * i / (FILTER_FIR_TAPS - 1));
+    taps[i] = sinc * window;
+    sum += taps[i];
+  }
+  for (int i = 0; i < FILTER_FIR_TAPS; i++) {
+    taps[i] /= sum;
+  }
+
+  delayMs = 1000.0f * (biquadDelay + center / sampleRateHz);
+  primed = false;
+  reset(0);
+}
+
+void PressureFilter::reset(float value) {
+  // DC gain is 1, so every section outputs the input value
+  for (int s = 0; s < FILTER_BIQUAD_SECTIONS; s++) {
+    z1[s] = value * (1.0f - sections[s].b0);
+    z2[s] = value * (sections[s].b2 - sections[s].a2);
+  }
+  for (int i = 0; i < FILTER_FIR_TAPS - 1; i++) {
+    history[i] = value;
+  }
+  primed = true;
+}
+
+void PressureFilter::process(float* samples, size_t count) {
+  if (count == 0) return;
+  if (!primed) reset(samples[0]);
+
+  while (count > 0) {
+    size_t block = count < FILTER_BLOCK_SIZE ? count : FILTER_BLOCK_SIZE;
+    processBlock(samples, block);
+    samples += block;
+    count -= block;
+  }
+}
+
+void PressureFilter::processBlock(float* samples, size_t count) {
+  // Biquad cascade: one section at a time over the whole block, with the
+  // state kept in registers
+  for (int s = 0; s < FILTER_BIQUAD_SECTIONS; s++) {
+    const float b0 = sections[s].b0, b1 = sections[s].b1, b2 = sections[s].b2;
+    const float a1 = sections[s].a1, a2 = sections[s].a2;
+    float s1 = z1[s], s2 = z2[s];
+    for (size_t i = 0; i < count; i++) {
+      float x = samples[i];
+      float y = b0 * x + s1;
+      s1 = b1 * x - a1 * y + s2;
+      s2 = b2 * x - a2 * y;
+      samples[i] = y;
+    }
+    z1[s] = s1;
+    z2[s] = s2;
+  }
+
+  // FIR: accumulate one tap at a time across the block. Each pass is an
+  // independent multiply-add over contiguous memory, which vectorizes.
+  float* __restrict input = history;
+  float* __restrict output = samples;
+  memcpy(input + FILTER_FIR_TAPS - 1, samples, count * sizeof(float));
+  for (size_t i = 0; i < count; i++) {
+    output[i] = 0;
+  }
+  for (int k = 0; k < FILTER_FIR_TAPS; k++) {
+    const float tap = taps[k];
+    const float* __restrict x = input + k;
+    for (size_t i = 0; i < count; i++) {
+      output[i] += tap * x[i];
+    }
+  }
+
+  // Keep the newest TAPS - 1 inputs for the next block
+  memmove(input, input + count, (FILTER_FIR_TAPS - 1) * sizeof(float));
+}
@@ -0,0 +1,57 @@
+#ifndef PRESSURE_FILTER_H
+#define PRESSURE_FILTER_H
+
+#include <stddef.h>
+#include "config.h"
+
+// One second-order section (transposed direct form II, a0 normalized to 1)
+struct Biquad {
+  float b0, b1, b2;
+  float a1, a2;
+};
+
+// Low-pass section from the RBJ audio EQ cookbook
+Biquad designLowpassBiquad(float cutoffHz, float sampleRateHz, float q);
+
+// Software low-pass between the Sampler and BreathData: a cascade of
+// Butterworth biquads followed by a short windowed-sinc FIR. Works on
+// blocks of samples in place so the inner loops stay branch-free; the
+// FIR loop runs over the block and vectorizes on the host.
+class PressureFilter {
+public:
+  // Design the coefficients for a sample rate and clear the history
+  void init(float sampleRateHz);
+
+  // Filter count samples in place. The first block primes the history
+  // with its first sample so there is no startup transient.
+  void process(float* samples, size_t count);
+
+  // Set every stage to the steady state for a constant input
+  void reset(float value);
+
+  // Approximate delay through the whole stage at breathing frequencies
+  float getDelayMs() const { return delayMs; }
+
+  float getSampleRateHz() const { return sampleRateHz; }
+
+private:
+  void processBlock(float* samples, size_t count);
+
+  Biquad sections[FILTER_BIQUAD_SECTIONS];
+  float z1[FILTER_BIQUAD_SECTIONS];
+  float z2[FILTER_BIQUAD_SECTIONS];
+
+  // Symmetric FIR taps; history holds the previous TAPS - 1 inputs
+  // followed by the block being filtered
+  float taps[FILTER_FIR_TAPS];
+  float history[FILTER_FIR_TAPS - 1 + FILTER_BLOCK_SIZE];
+
+  float sampleRateHz = 0;
+  float delayMs = 0;
+  bool primed = false;
+};
+
+// Global filter instance (defined in main.cpp)
+extern PressureFilter pressureFilter;
+
+#endif // PRESSURE_FILTER_H
@@ -0,0 +1,99 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <stdint.h>
+#include <string.h>
+#include "config.h"
+#include "FrameCanvas.h"
+
+// Span fills written straight into a FrameCanvas buffer (RGB565 or
+// palette index). Coordinates are screen coordinates; each call clips
+// once to the strip's rows and then runs a plain store loop, skipping
+// the Adafruit_GFX virtual dispatch and per-call rotation/clipping of
+// drawFastHLine(), drawFastVLine() and fillRect(). Text and shapes
+// still go through the canvas; the result is identical pixel for pixel.
+class Raster {
+public:
+  explicit Raster(FrameCanvas& canvas)
+    : buffer(canvas.getBuffer()),
+      width(canvas.width()),
+      top(canvas.getOriginY()),
+      bottom(canvas.getOriginY() + canvas.getRows()) {}
+
+  // Every row the canvas holds
+  void fill(Pixel color) {
+    fillPixels(buffer, (int32_t)width * (bottom - top), color);
+  }
+
+  // Pixels [x0, x1) of row y
+  void fillRow(int y, int x0, int x1, Pixel color) {
+    if (y < top || y >= bottom) return;
+    if (x0 < 0) x0 = 0;
+    if (x1 > width) x1 = width;
+    if (x0 >= x1) return;
+    fillPixels(buffer + (y - top) * width + x0, x1 - x0, color);
+  }
+
+  // Pixels [y0, y1) of column x
+  void fillColumn(int x, int y0, int y1, Pixel color) {
+    if (x < 0 || x >= width) return;
+    if (y0 < top) y0 = top;
+    if (y1 > bottom) y1 = bottom;
+    Pixel* pixel = buffer + (y0 - top) * width + x;
+    for (int y = y0; y < y1; y++) {
+      *pixel = color;
+      pixel += width;
+    }
+  }
+
+  // Same arguments as Adafruit_GFX::fillRect()
+  void fillRect(int x, int y, int w, int h, Pixel color) {
+    int x1 = x + w;
+    int y1 = y + h;
+    if (x < 0) x = 0;
+    if (y < top) y = top;
+    if (x1 > width) x1 = width;
+    if (y1 > bottom) y1 = bottom;
+    if (x >= x1) return;
+    for (int row = y; row < y1; row++) {
+      fillPixels(buffer + (row - top) * width + x, x1 - x, color);
+    }
+  }
+
+  // Fill count pixels. 8-bit pixels are a memset. With
+  // RASTER_PAIR_WRITES, 16-bit pixels are stored two per 32-bit write
+  // after aligning to a word (the ESP32 faults on unaligned 32-bit
+  // stores). Both halves hold the same color, so byte order does not
+  // matter.
+  static void fillPixels(Pixel* pixel, int32_t count, Pixel color) {
+#if DISPLAY_INDEXED_COLOR
+    if (count > 0) memset(pixel, color, count);
+#elif RASTER_PAIR_WRITES
+    if (count > 0 && ((uintptr_t)pixel & 2)) {
+      *pixel++ = color;
+      count--;
+    }
+    PixelPair pair = color | ((uint32_t)color << 16);
+    PixelPair* pairs = (PixelPair*)pixel;
+    for (int32_t i = count >> 1; i > 0; i--) {
+      *pairs++ = pair;
+    }
+    if (count & 1) *(Pixel*)pairs = color;
+#else
+    for (int32_t i = 0; i < count; i++) {
+      pixel[i] = color;
+    }
+#endif
+  }
+
+private:
+  // 32-bit store allowed to alias the 16-bit pixels
+  typedef uint32_t __attribute__((__may_alias__)) PixelPair;
+
+  Pixel* buffer;  // Row `top`
+  int width;
+  int top;
+  int bottom;
+};
+
+#endif // RASTER_H
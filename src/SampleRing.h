@@ -0,0 +1,57 @@
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// Timestamped pressure sample captured by the sampling task
+struct Sample {
+  unsigned long timestamp;  // millis() when the sensor was read
+  float pressureDelta;      // Pa relative to baseline
+  uint32_t captureMicros;   // micros() when the read started (latency tracing)
+  uint32_t readMicros;      // Time spent reading the sensor
+  float pressure;           // Absolute Pa (display only)
+  float temperature;        // Celsius (display only)
+};
+
+// Lock-free single-producer/single-consumer ring buffer.
+// One task may push() and one other task may pop() concurrently without locks.
+template <typename T, size_t Capacity>
+class SampleRing {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "SampleRing capacity must be a power of two");
+
+public:
+  // Producer side: returns false (and drops the item) when the ring is full
+  bool push(const T& item) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= Capacity) return false;
+    buffer[h & (Capacity - 1)] = item;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side: returns false when the ring is empty
+  bool pop(T& item) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) return false;
+    item = buffer[t & (Capacity - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Number of items waiting (approximate while the producer is running)
+  size_t size() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+  }
+
+  static constexpr size_t capacity() { return Capacity; }
+
+private:
+  T buffer[Capacity];
+  std::atomic<size_t> head{0};
+  std::atomic<size_t> tail{0};
+};
+
+#endif // SAMPLE_RING_H
@@ -0,0 +1,129 @@
+// Standard headers first: the simulator's Arduino.h min/max macros break them
+#ifdef SIMULATOR
+  #include <chrono>
+  #include <thread>
+#else
+  #include <freertos/FreeRTOS.h>
+  #include <freertos/task.h>
+#endif
+
+#include "Sampler.h"
+#include "Sensor.h"
+
+void Sampler::start(uint32_t period) {
+  if (running) return;
+  periodMs = period;
+  running = true;
+
+#if defined(HEADLESS)
+  // Driven from the harness through poll()
+  nextSampleTime = millis();
+#elif defined(SIMULATOR)
+  std::thread(taskEntry, this).detach();
+#else
+  // Pin to the core the Arduino loop does not run on
+  xTaskCreatePinnedToCore(taskEntry, "sampler", 4096, this,
+                          SAMPLER_TASK_PRIORITY, nullptr, SAMPLER_TASK_CORE);
+#endif
+
+  if (periodMs == 0) {
+    Serial.println("Sampler started (free-running)");
+  } else {
+    Serial.print("Sampler started at ");
+    Serial.print((int)(1000 / periodMs));
+    Serial.println(" Hz");
+  }
+}
+
+void Sampler::poll() {
+  if (!running || paused.load()) return;
+
+  if (periodMs == 0) {
+    while (ring.size() < SAMPLE_RING_SIZE) {
+      sampleOnce();
+    }
+    return;
+  }
+
+  while ((long)(millis() - nextSampleTime) >= 0) {
+    sampleOnce();
+    nextSampleTime += periodMs;
+  }
+}
+
+void Sampler::pause() {
+  paused.store(true);
+  while (busy.load()) {
+    delay(1);
+  }
+}
+
+void Sampler::resume() {
+  paused.store(false);
+}
+
+void Sampler::sampleOnce() {
+  // Flag the read before checking paused so pause() can wait for it
+  busy.store(true);
+  if (paused.load()) {
+    busy.store(false);
+    return;
+  }
+
+  uint32_t start = micros();
+  pressureSensor.update();
+
+  Sample sample;
+  sample.timestamp = pressureSensor.getSampleTime();
+  sample.pressureDelta = pressureSensor.getDelta();
+  sample.captureMicros = start;
+  sample.readMicros = micros() - start;
+  sample.pressure = pressureSensor.getAbsolutePressure();
+  sample.temperature = pressureSensor.getTemperature();
+
+  produced.fetch_add(1, std::memory_order_relaxed);
+  if (!ring.push(sample)) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+  busy.store(false);
+}
+
+void Sampler::taskEntry(void* arg) {
+  Sampler* self = static_cast<Sampler*>(arg);
+
+#ifdef SIMULATOR
+  // Absolute deadlines so the sample clock does not drift with read time
+  auto next = std::chrono::steady_clock::now();
+  while (true) {
+    if (self->periodMs == 0) {
+      // Free-running: produce as fast as the consumer drains, never drop
+      if (self->ring.size() >= SAMPLE_RING_SIZE) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      } else {
+        self->sampleOnce();
+      }
+      continue;
+    }
+
+    self->sampleOnce();
+    next += std::chrono::milliseconds(self->periodMs);
+    std::this_thread::sleep_until(next);
+  }
+#else
+  TickType_t lastWake = xTaskGetTickCount();
+  while (true) {
+    if (self->periodMs == 0) {
+      // Free-running: produce as fast as the consumer drains, never drop
+      if (self->ring.size() >= SAMPLE_RING_SIZE) {
+        vTaskDelay(1);
+      } else {
+        self->sampleOnce();
+      }
+      continue;
+    }
+
+    self->sampleOnce();
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(self->periodMs));
+  }
+#endif
+}
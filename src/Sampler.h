@@ -0,0 +1,59 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include "config.h"
+#include "SampleRing.h"
+
+// Samples the pressure sensor at a fixed rate on its own task
+// (FreeRTOS task on ESP32, std::thread in the simulator) so that slow
+// display transfers never delay or jitter the sample clock.
+class Sampler {
+public:
+  // Start the sampling task (call after the sensor baseline is calibrated).
+  // A period of 0 free-runs: samples are produced as fast as they are
+  // consumed and the producer waits instead of dropping when the ring fills.
+  void start(uint32_t periodMs = SAMPLE_PERIOD_MS);
+
+  // Take every sample that has come due by millis(). Only needed in
+  // HEADLESS builds, which have no sampling thread and a virtual clock.
+  void poll();
+
+  // Stop touching the sensor until resume(); returns once any in-flight
+  // read has finished so the caller has exclusive access to the sensor
+  void pause();
+  void resume();
+
+  // Pop the oldest pending sample; returns false when none are waiting
+  bool read(Sample& sample) { return ring.pop(sample); }
+
+  // Number of samples waiting to be consumed
+  size_t available() const { return ring.size(); }
+
+  // Samples taken since start
+  unsigned long getSampleCount() const { return produced.load(std::memory_order_relaxed); }
+
+  // Samples lost because the consumer fell behind
+  unsigned long getDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+  uint32_t getPeriodMs() const { return periodMs; }
+
+private:
+  // Read the sensor once and queue the result
+  void sampleOnce();
+
+  static void taskEntry(void* arg);
+
+  SampleRing<Sample, SAMPLE_RING_SIZE> ring;
+  std::atomic<unsigned long> produced{0};
+  std::atomic<unsigned long> dropped{0};
+  std::atomic<bool> paused{false};
+  std::atomic<bool> busy{false};
+  uint32_t periodMs = SAMPLE_PERIOD_MS;
+  unsigned long nextSampleTime = 0;
+  bool running = false;
+};
+
+// Global sampler instance (defined in main.cpp)
+extern Sampler sampler;
+
+#endif // SAMPLER_H
@@ -0,0 +1,158 @@
+// Standard headers first: the simulator's Arduino.h min/max macros break them
+#ifdef SIMULATOR
+  #include <chrono>
+  #include <thread>
+#else
+  #include <freertos/FreeRTOS.h>
+  #include <freertos/task.h>
+#endif
+#include <string.h>
+
+#include "Scheduler.h"
+
+int Scheduler::addTask(const char* name, TaskFunction function, uint32_t periodMicros) {
+  if (taskCount >= SCHEDULER_MAX_TASKS) return -1;
+
+  uint32_t now = micros();
+  Task& task = tasks[taskCount];
+  task.name = name;
+  task.function = function;
+  task.periodMicros = periodMicros;
+  task.releaseMicros = now + periodMicros;
+  task.lastRunMicros = now;
+  memset(&task.stats, 0, sizeof(task.stats));
+  return taskCount++;
+}
+
+void Scheduler::setPeriod(int task, uint32_t periodMicros) {
+  tasks[task].periodMicros = periodMicros;
+}
+
+void Scheduler::runDue() {
+  // Each task runs at most once per call, so one that cannot keep up
+  // does not starve the caller
+  uint32_t ran = 0;
+  for (;;) {
+    uint32_t now = micros();
+    int next = -1;
+    for (int i = 0; i < taskCount; i++) {
+      const Task& task = tasks[i];
+      if ((ran & (1UL << i)) || (int32_t)(now - task.releaseMicros) < 0) continue;
+      // Earliest deadline first (the deadline is the next release)
+      if (next < 0 || (int32_t)((task.releaseMicros + task.periodMicros) -
+                                (tasks[next].releaseMicros + tasks[next].periodMicros)) < 0) {
+        next = i;
+      }
+    }
+    if (next < 0) return;
+
+    ran |= 1UL << next;
+    runTask(tasks[next], now);
+  }
+}
+
+void Scheduler::runTask(Task& task, uint32_t startMicros) {
+  task.function(startMicros - task.lastRunMicros);
+  uint32_t endMicros = micros();
+  task.lastRunMicros = startMicros;
+
+  TaskStats& stats = task.stats;
+  uint32_t lateMicros = startMicros - task.releaseMicros;
+  uint32_t runMicros = endMicros - startMicros;
+  stats.runs++;
+  stats.totalLateMicros += lateMicros;
+  if (lateMicros > stats.maxLateMicros) stats.maxLateMicros = lateMicros;
+  if (runMicros > stats.maxRunMicros) stats.maxRunMicros = runMicros;
+
+  // Next release on the grid. If it has passed too, keep the latest
+  // release that has passed and drop the ones before it.
+  task.releaseMicros += task.periodMicros;
+  int32_t behindMicros = (int32_t)(endMicros - task.releaseMicros);
+  if (behindMicros > 0) {
+    stats.overruns++;
+    uint32_t skipped = (uint32_t)behindMicros / task.periodMicros;
+    task.releaseMicros += skipped * task.periodMicros;
+    stats.skipped += skipped;
+  }
+}
+
+uint32_t Scheduler::untilNextRelease() const {
+  if (taskCount == 0) return 0;
+
+  uint32_t now = micros();
+  int32_t wait = INT32_MAX;
+  for (int i = 0; i < taskCount; i++) {
+    int32_t untilRelease = (int32_t)(tasks[i].releaseMicros - now);
+    if (untilRelease < wait) wait = untilRelease;
+  }
+  return wait > 0 ? (uint32_t)wait : 0;
+}
+
+void Scheduler::sleepUntilNextRelease() {
+  uint32_t wait = untilNextRelease();
+#if defined(HEADLESS)
+  // Time only moves when the harness advances the virtual clock
+  (void)wait;
+#elif defined(SIMULATOR)
+  std::this_thread::sleep_for(std::chrono::microseconds(wait));
+#else
+  if (wait >= 1000) {
+    delay(wait / 1000);
+  } else if (wait > 0) {
+    delayMicroseconds(wait);
+  }
+#endif
+}
+
+void Scheduler::startTask(int core, int priority) {
+#ifdef SIMULATOR
+  // No cores or priorities to pick on the desktop
+  (void)core;
+  (void)priority;
+#ifndef HEADLESS
+  std::thread(taskEntry, this).detach();
+#endif
+#else
+  xTaskCreatePinnedToCore(taskEntry, name, 4096, this, priority, nullptr, core);
+#endif
+}
+
+void Scheduler::taskEntry(void* arg) {
+  Scheduler* self = static_cast<Scheduler*>(arg);
+  while (true) {
+    self->runDue();
+    self->sleepUntilNextRelease();
+  }
+}
+
+void Scheduler::resetStats() {
+  for (int i = 0; i < taskCount; i++) {
+    memset(&tasks[i].stats, 0, sizeof(tasks[i].stats));
+  }
+}
+
+void Scheduler::report() const {
+  Serial.print("Scheduler tasks: ");
+  Serial.print(name);
+  Serial.println(" (ms)");
+  Serial.println("Task      Period  Runs  Overruns  Skipped  Late mean  Late max  Run max");
+  for (int i = 0; i < taskCount; i++) {
+    const Task& task = tasks[i];
+    const TaskStats& stats = task.stats;
+    Serial.print(task.name);
+    for (int pad = strlen(task.name); pad < 10; pad++) Serial.print(" ");
+    Serial.print(task.periodMicros / 1000.0f, 1);
+    Serial.print("  ");
+    Serial.print((unsigned)stats.runs);
+    Serial.print("  ");
+    Serial.print((unsigned)stats.overruns);
+    Serial.print("  ");
+    Serial.print((unsigned)stats.skipped);
+    Serial.print("  ");
+    Serial.print(stats.runs > 0 ? (float)(stats.totalLateMicros / stats.runs) / 1000.0f : 0.0f, 3);
+    Serial.print("  ");
+    Serial.print(stats.maxLateMicros / 1000.0f, 3);
+    Serial.print("  ");
+    Serial.println(stats.maxRunMicros / 1000.0f, 3);
+  }
+}
@@ -0,0 +1,86 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Called with the microseconds since the task's previous run (its period
+// on the first run)
+typedef void (*TaskFunction)(uint32_t elapsedMicros);
+
+// Timing of one task since the last resetStats()
+struct TaskStats {
+  unsigned long runs;
+  unsigned long overruns;   // Runs that finished after their deadline (the next release)
+  unsigned long skipped;    // Releases dropped to catch up
+  uint64_t totalLateMicros; // Start time after release, summed (jitter)
+  uint32_t maxLateMicros;
+  uint32_t maxRunMicros;
+};
+
+// Cooperative scheduler for the main loop. Each task is released every
+// period on a fixed grid (release N is start + N * period, so rates do
+// not drift with run time) and should finish before its next release.
+// Due tasks run earliest deadline first. A task that falls more than a
+// period behind runs once for the latest release it missed and skips
+// the older ones instead of running back to back to catch up.
+class Scheduler {
+public:
+  // name labels the report
+  explicit Scheduler(const char* name) : name(name) {}
+
+  // Returns the task id, or -1 when SCHEDULER_MAX_TASKS are registered.
+  // The first release is one period from now.
+  int addTask(const char* name, TaskFunction function, uint32_t periodMicros);
+
+  // Takes effect from the task's next release
+  void setPeriod(int task, uint32_t periodMicros);
+
+  // Run every task whose release time has passed
+  void runDue();
+
+  // Microseconds until the next release (0 when a task is due)
+  uint32_t untilNextRelease() const;
+
+  // Sleep until the next release (ESP32: delay() yields the core to
+  // other FreeRTOS tasks, sub-millisecond waits spin)
+  void sleepUntilNextRelease();
+
+  // Run the tasks from now on in a task of their own, pinned to core on
+  // the ESP32 (std::thread in the simulator). HEADLESS builds have no
+  // threads: the harness keeps calling runDue() instead.
+  void startTask(int core, int priority);
+
+  const TaskStats& getStats(int task) const { return tasks[task].stats; }
+  int getTaskCount() const { return taskCount; }
+
+  void resetStats();
+
+  // Print period, runs, overruns, jitter and run time per task over Serial
+  void report() const;
+
+private:
+  struct Task {
+    const char* name;
+    TaskFunction function;
+    uint32_t periodMicros;
+    uint32_t releaseMicros;   // Next release
+    uint32_t lastRunMicros;
+    TaskStats stats;
+  };
+
+  void runTask(Task& task, uint32_t startMicros);
+  static void taskEntry(void* arg);
+
+  const char* name;
+  Task tasks[SCHEDULER_MAX_TASKS];
+  int taskCount = 0;
+};
+
+// Global schedulers (defined in main.cpp): the main loop's (render),
+// the detection task's and the storage task's
+extern Scheduler scheduler;
+extern Scheduler detectScheduler;
+extern Scheduler storageScheduler;
+
+#endif // SCHEDULER_H
@@ -1,11 +1,110 @@
 #include "Sensor.h"
+#include "SensorProfile.h"
 #include "Display.h"
 #include "config.h"
 #include <Wire.h>
 #include <Adafruit_BMP280.h>
 
-// Internal BMP280 handle
+// Internal BMP280 handle (used for setup; samples use the burst path below)
 static Adafruit_BMP280 bmp;
+static uint8_t bmpAddress = 0x76;
+
+// BMP280 registers (datasheet section 4.3)
+#define BMP280_REG_CALIB      0x88  // 24 bytes of trimming parameters
+#define BMP280_REG_PRESS_MSB  0xF7  // press_msb..temp_xlsb, 6 bytes
+
+// Address (W) + register pointer + address (R) + 6 data bytes
+#define BMP280_BURST_BUS_BYTES  9
+
+// Factory trimming parameters for integer compensation
+struct Bmp280Calib {
+  uint16_t t1;
+  int16_t t2, t3;
+  uint16_t p1;
+  int16_t p2, p3, p4, p5, p6, p7, p8, p9;
+};
+static Bmp280Calib calib;
+
+static Adafruit_BMP280::sensor_sampling toSampling(uint8_t oversampling) {
+  switch (oversampling) {
+    case 1:  return Adafruit_BMP280::SAMPLING_X1;
+    case 2:  return Adafruit_BMP280::SAMPLING_X2;
+    case 4:  return Adafruit_BMP280::SAMPLING_X4;
+    case 8:  return Adafruit_BMP280::SAMPLING_X8;
+    default: return Adafruit_BMP280::SAMPLING_X16;
+  }
+}
+
+static Adafruit_BMP280::sensor_filter toFilter(uint8_t coefficient) {
+  switch (coefficient) {
+    case 1:  return Adafruit_BMP280::FILTER_OFF;
+    case 2:  return Adafruit_BMP280::FILTER_X2;
+    case 4:  return Adafruit_BMP280::FILTER_X4;
+    case 8:  return Adafruit_BMP280::FILTER_X8;
+    default: return Adafruit_BMP280::FILTER_X16;
+  }
+}
+
+// Read consecutive registers in a single I2C transaction
+static bool readRegisters(uint8_t reg, uint8_t* buffer, size_t length) {
+  Wire.beginTransmission(bmpAddress);
+  Wire.write(reg);
+  if (Wire.endTransmission(false) != 0) return false;
+  if (Wire.requestFrom(bmpAddress, length) != length) return false;
+  for (size_t i = 0; i < length; i++) {
+    buffer[i] = Wire.read();
+  }
+  return true;
+}
+
+static bool readCalibration() {
+  uint8_t b[24];
+  if (!readRegisters(BMP280_REG_CALIB, b, sizeof(b))) return false;
+
+  // Little-endian 16-bit words, in register order
+  calib.t1 = (uint16_t)(b[1] << 8 | b[0]);
+  calib.t2 = (int16_t)(b[3] << 8 | b[2]);
+  calib.t3 = (int16_t)(b[5] << 8 | b[4]);
+  calib.p1 = (uint16_t)(b[7] << 8 | b[6]);
+  calib.p2 = (int16_t)(b[9] << 8 | b[8]);
+  calib.p3 = (int16_t)(b[11] << 8 | b[10]);
+  calib.p4 = (int16_t)(b[13] << 8 | b[12]);
+  calib.p5 = (int16_t)(b[15] << 8 | b[14]);
+  calib.p6 = (int16_t)(b[17] << 8 | b[16]);
+  calib.p7 = (int16_t)(b[19] << 8 | b[18]);
+  calib.p8 = (int16_t)(b[21] << 8 | b[20]);
+  calib.p9 = (int16_t)(b[23] << 8 | b[22]);
+  return true;
+}
+
+// Bosch reference compensation (datasheet section 8.2), integer only.
+// Returns temperature in 0.01 C and sets tFine for pressure compensation.
+static int32_t compensateTemperature(int32_t adcT, int32_t& tFine) {
+  int32_t var1 = ((((adcT >> 3) - ((int32_t)calib.t1 << 1))) * ((int32_t)calib.t2)) >> 11;
+  int32_t var2 = (((((adcT >> 4) - ((int32_t)calib.t1)) *
+                    ((adcT >> 4) - ((int32_t)calib.t1))) >> 12) *
+                  ((int32_t)calib.t3)) >> 14;
+  tFine = var1 + var2;
+  return (tFine * 5 + 128) >> 8;
+}
+
+// Returns pressure in Pa as unsigned Q24.8 (Pa * 256), 0 on invalid trimming
+static uint32_t compensatePressure(int32_t adcP, int32_t tFine) {
+  int64_t var1 = ((int64_t)tFine) - 128000;
+  int64_t var2 = var1 * var1 * (int64_t)calib.p6;
+  var2 = var2 + ((var1 * (int64_t)calib.p5) << 17);
+  var2 = var2 + (((int64_t)calib.p4) << 35);
+  var1 = ((var1 * var1 * (int64_t)calib.p3) >> 8) + ((var1 * (int64_t)calib.p2) << 12);
+  var1 = ((((int64_t)1) << 47) + var1) * ((int64_t)calib.p1) >> 33;
+  if (var1 == 0) return 0;  // Avoid division by zero
+
+  int64_t p = 1048576 - adcP;
+  p = (((p << 31) - var2) * 3125) / var1;
+  var1 = (((int64_t)calib.p9) * (p >> 13) * (p >> 13)) >> 25;
+  var2 = (((int64_t)calib.p8) * p) >> 19;
+  p = ((p + var1 + var2) >> 8) + (((int64_t)calib.p7) << 4);
+  return (uint32_t)p;
+}
 
 void Sensor::init() {
   Serial.println("Initializing BMP280 sensor...");
@@ -14,6 +113,7 @@ void Sensor::init() {
 
   // Initialize BMP280 - specify chip ID explicitly for GY-BMP280 clones
   unsigned status = bmp.begin(0x76, 0x58);
+  bmpAddress = 0x76;
   if (!status) {
     Serial.println("ERROR: Could not find BMP280 sensor at 0x76!");
     Serial.print("SensorID was: 0x");
@@ -21,6 +121,7 @@ void Sensor::init() {
 
     Serial.println("Trying alternate address 0x77 with chip ID 0x58...");
     status = bmp.begin(0x77, 0x58);
+    bmpAddress = 0x77;
     if (!status) {
       Serial.println("Failed at 0x77 too!");
       Serial.println("ID of 0xFF = bad address or BMP180/BMP085");
@@ -32,12 +133,12 @@ void Sensor::init() {
 
   Serial.println("BMP280 initialized successfully!");
 
-  // Configure BMP280 for high precision
-  bmp.setSampling(Adafruit_BMP280::MODE_NORMAL,
-                  Adafruit_BMP280::SAMPLING_X16,  // Pressure oversampling
-                  Adafruit_BMP280::SAMPLING_X2,   // Temperature oversampling
-                  Adafruit_BMP280::FILTER_X16,    // Filtering
-                  Adafruit_BMP280::STANDBY_MS_1); // Standby time
+  setProfile(DEFAULT_SENSOR_PROFILE);
+
+  // Keep our own copy of the trimming parameters for the burst-read path
+  if (!readCalibration()) {
+    Serial.println("ERROR: Could not read BMP280 calibration data!");
+  }
 }
 
 void Sensor::calibrateBaseline() {
@@ -48,21 +149,77 @@ void Sensor::calibrateBaseline() {
   // Take average of 50 readings
   float sum = 0;
   for (int i = 0; i < 50; i++) {
-    sum += bmp.readPressure();
+    update();
+    sum += currentPressure;
     delay(20);
   }
 
   baselinePressure = sum / 50.0f;
+  pressureDelta = currentPressure - baselinePressure;
 
   Serial.print("Baseline pressure: ");
   Serial.print(baselinePressure);
   Serial.println(" Pa");
 
+  Serial.print("Sample cost: ");
+  Serial.print(readBytes);
+  Serial.print(" I2C bytes, ");
+  Serial.print(readMicros);
+  Serial.println(" us");
+
   display.clear();
 }
 
+void Sensor::setProfile(SensorProfile newProfile) {
+  const SensorProfileConfig& config = getSensorProfileConfig(newProfile);
+  profile = newProfile;
+
+  // STANDBY_MS_1 is the chip's 0.5 ms setting, used by every profile
+  bmp.setSampling(Adafruit_BMP280::MODE_NORMAL,
+                  toSampling(config.temperatureOversampling),
+                  toSampling(config.pressureOversampling),
+                  toFilter(config.filterCoefficient),
+                  Adafruit_BMP280::STANDBY_MS_1);
+
+  Serial.print("Sensor profile: ");
+  Serial.println(config.name);
+}
+
 void Sensor::update() {
-  currentPressure = bmp.readPressure();
-  currentTemperature = bmp.readTemperature();
-  pressureDelta = currentPressure - baselinePressure;
+  unsigned long start = micros();
+  sampleTime = millis();
+
+  // One burst read of press_msb..temp_xlsb latches a consistent pair
+  uint8_t b[6];
+  if (!readRegisters(BMP280_REG_PRESS_MSB, b, sizeof(b))) {
+    readBytes = 0;
+    readMicros = micros() - start;
+    return;
+  }
+
+  int32_t adcP = ((int32_t)b[0] << 12) | ((int32_t)b[1] << 4) | (b[2] >> 4);
+  int32_t adcT = ((int32_t)b[3] << 12) | ((int32_t)b[4] << 4) | (b[5] >> 4);
+
+  // Temperature compensation runs once and feeds the pressure formula
+  int32_t tFine;
+  int32_t temperature = compensateTemperature(adcT, tFine);
+  uint32_t pressure = compensatePressure(adcP, tFine);
+
+  if (pressure != 0) {
+    currentTemperature = temperature / 100.0f;
+    currentPressure = pressure / 256.0f;
+    pressureDelta = currentPressure - baselinePressure;
+  }
+
+  readBytes = BMP280_BURST_BUS_BYTES;
+  readMicros = micros() - start;
+
+#if SENSOR_TRACE_SERIAL
+  // timestamp_ms,pressure_pa,temperature_c (replayable in the simulator)
+  Serial.print(sampleTime);
+  Serial.print(",");
+  Serial.print(currentPressure, 3);
+  Serial.print(",");
+  Serial.println(currentTemperature, 2);
+#endif
 }
@@ -1,6 +1,13 @@
 #ifndef SENSOR_H
 #define SENSOR_H
 
+#include "config.h"
+
+#ifdef SIMULATOR
+#include <atomic>
+struct SyntheticBreathParams;
+#endif
+
 class Sensor {
 public:
   // Initialize sensor
@@ -12,6 +19,10 @@ public:
   // Update current pressure reading (call every loop)
   void update();
 
+  // Switch oversampling/filter profile at runtime (baseline is kept)
+  void setProfile(SensorProfile profile);
+  SensorProfile getProfile() const { return profile; }
+
   // Get raw pressure delta from baseline (in Pascals)
   float getDelta() const { return pressureDelta; }
 
@@ -21,19 +32,54 @@ public:
   // Get current temperature in Celsius
   float getTemperature() const { return currentTemperature; }
 
+  // Get the time (ms) the current reading was captured
+  unsigned long getSampleTime() const { return sampleTime; }
+
+  // Cost of the last update(): I2C bytes on the bus and time spent (us)
+  unsigned int getReadBytes() const { return readBytes; }
+  unsigned long getReadMicros() const { return readMicros; }
+
 #ifdef SIMULATOR
-  // Simulator only: set pressure from mouse Y position
+  // Simulator only: set pressure from mouse Y position (SDL thread; the
+  // sampler thread reads it)
   void setMouseY(int mouseY, int windowHeight);
+
+  // Simulator only: replay a recorded CSV trace instead of the mouse
+  bool replayTrace(const char* path, bool loop);
+
+  // Simulator only: generate synthetic breathing instead of the mouse
+  void useSyntheticBreath(const SyntheticBreathParams& params);
+
+  // Simulator only: write every reading to a CSV trace
+  bool recordTrace(const char* path);
+
+  // Simulator only: trace sources advance one point per update() instead
+  // of following millis(), so samples arrive as fast as they are consumed
+  void setFreeRunning(bool enabled) { _freeRunning = enabled; }
+  bool isFreeRunning() const { return _freeRunning; }
+
+  // Simulator only: true once a non-looping replay has run out
+  bool isTraceFinished() const;
 private:
-  int _mouseY = 0;
-  int _windowHeight = 512;
+  void updateFromMouse();
+  void updateFromTrace();
+  bool _freeRunning = false;
+  std::atomic<int> _mouseY{0};
+  std::atomic<int> _windowHeight{512};
+  // Modeled BMP280 conversions for the active profile
+  float _nextConversionMs = 0;
+  float _filteredDelta = 0;
 #endif
 
 private:
+  SensorProfile profile = DEFAULT_SENSOR_PROFILE;
   float baselinePressure = 0;
   float currentPressure = 0;
   float currentTemperature = 0;
   float pressureDelta = 0;
+  unsigned long sampleTime = 0;
+  unsigned int readBytes = 0;
+  unsigned long readMicros = 0;
 };
 
 // Global sensor instance (defined in main.cpp)
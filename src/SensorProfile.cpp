@@ -0,0 +1,117 @@
+#include "SensorProfile.h"
+#include "Sensor.h"
+#include <math.h>
+
+// Indexed by SensorProfile
+static const SensorProfileConfig profileConfigs[SENSOR_PROFILE_COUNT] = {
+  // name          P x  T x  IIR  standby
+  { "low-latency",   2,   1,   1,  0.5f },
+  { "balanced",      4,   1,   4,  0.5f },
+  { "low-noise",    16,   2,  16,  0.5f },
+};
+
+const SensorProfileConfig& getSensorProfileConfig(SensorProfile profile) {
+  if (profile < 0 || profile >= SENSOR_PROFILE_COUNT) {
+    profile = DEFAULT_SENSOR_PROFILE;
+  }
+  return profileConfigs[profile];
+}
+
+float expectedOutputDataRate(const SensorProfileConfig& config) {
+  // Typical measurement time (datasheet section 3.8.1) plus standby
+  float measureMs = 1.0f + 2.0f * config.temperatureOversampling +
+                    2.0f * config.pressureOversampling + 0.5f;
+  return 1000.0f / (measureMs + config.standbyMs);
+}
+
+int filterSettlingSamples(uint8_t filterCoefficient) {
+  if (filterCoefficient <= 1) return 1;
+
+  // Each conversion keeps (c-1)/c of the previous filtered value
+  float retained = 1.0f - 1.0f / filterCoefficient;
+  return (int)ceilf(logf(0.1f) / logf(retained));
+}
+
+SensorProfileStats measureSensorProfile(Sensor& sensor, SensorProfile profile) {
+  const SensorProfileConfig& config = getSensorProfileConfig(profile);
+  sensor.setProfile(profile);
+
+  // Let the IIR filter converge on the new settings
+  unsigned long start = millis();
+  while (millis() - start < PROFILE_SETTLE_MS) {
+    sensor.update();
+    delay(1);
+  }
+
+  // Poll faster than the sensor converts; a changed reading marks a new
+  // conversion. Pressure noise is accumulated per conversion (Welford).
+  float lastPressure = sensor.getAbsolutePressure();
+  float lastTemperature = sensor.getTemperature();
+  unsigned long firstConversion = 0;
+  unsigned long lastConversion = 0;
+  int conversions = 0;
+  double mean = 0;
+  double m2 = 0;
+
+  start = millis();
+  while (millis() - start < PROFILE_MEASURE_MS) {
+    sensor.update();
+    float pressure = sensor.getAbsolutePressure();
+    float temperature = sensor.getTemperature();
+
+    if (pressure != lastPressure || temperature != lastTemperature) {
+      unsigned long now = millis();
+      if (conversions == 0) firstConversion = now;
+      lastConversion = now;
+      conversions++;
+
+      double delta = pressure - mean;
+      mean += delta / conversions;
+      m2 += delta * (pressure - mean);
+
+      lastPressure = pressure;
+      lastTemperature = temperature;
+    }
+
+    delay(1);
+  }
+
+  SensorProfileStats stats;
+  stats.outputDataRateHz = 0;
+  if (conversions > 1 && lastConversion > firstConversion) {
+    stats.outputDataRateHz = (conversions - 1) * 1000.0f / (lastConversion - firstConversion);
+  }
+  stats.noiseRmsPa = conversions > 1 ? (float)sqrt(m2 / (conversions - 1)) : 0;
+
+  // The filter response is deterministic, so derive the step delay from the
+  // measured conversion period rather than requiring a real pressure step
+  float rate = stats.outputDataRateHz > 0 ? stats.outputDataRateHz : expectedOutputDataRate(config);
+  stats.stepDelayMs = filterSettlingSamples(config.filterCoefficient) * 1000.0f / rate;
+
+  return stats;
+}
+
+void reportSensorProfiles(Sensor& sensor) {
+  SensorProfile original = sensor.getProfile();
+
+  Serial.println("Measuring sensor profiles - keep the tube still...");
+  Serial.println("Profile      ODR Hz  (typ)  Step90 ms  Noise Pa RMS");
+
+  for (int i = 0; i < SENSOR_PROFILE_COUNT; i++) {
+    SensorProfile profile = (SensorProfile)i;
+    const SensorProfileConfig& config = getSensorProfileConfig(profile);
+    SensorProfileStats stats = measureSensorProfile(sensor, profile);
+
+    Serial.print(config.name);
+    for (int pad = strlen(config.name); pad < 13; pad++) Serial.print(" ");
+    Serial.print(stats.outputDataRateHz, 1);
+    Serial.print("  (");
+    Serial.print(expectedOutputDataRate(config), 0);
+    Serial.print(")  ");
+    Serial.print(stats.stepDelayMs, 1);
+    Serial.print("  ");
+    Serial.println(stats.noiseRmsPa, 3);
+  }
+
+  sensor.setProfile(original);
+}
@@ -0,0 +1,41 @@
+#ifndef SENSOR_PROFILE_H
+#define SENSOR_PROFILE_H
+
+#include "config.h"
+
+class Sensor;
+
+// BMP280 settings behind each SensorProfile
+struct SensorProfileConfig {
+  const char* name;
+  uint8_t pressureOversampling;     // 1, 2, 4, 8 or 16
+  uint8_t temperatureOversampling;  // 1, 2, 4, 8 or 16
+  uint8_t filterCoefficient;        // IIR coefficient, 1 = filter off
+  float standbyMs;                  // Normal-mode standby between conversions
+};
+
+// Measured behavior of a profile
+struct SensorProfileStats {
+  float outputDataRateHz;  // New conversions per second
+  float stepDelayMs;       // Time for the IIR output to reach 90% of a step
+  float noiseRmsPa;        // RMS deviation from the mean at rest
+};
+
+// Look up the settings for a profile
+const SensorProfileConfig& getSensorProfileConfig(SensorProfile profile);
+
+// Datasheet (typical) output data rate for a profile
+float expectedOutputDataRate(const SensorProfileConfig& config);
+
+// Number of conversions for the IIR filter to reach 90% of a step
+int filterSettlingSamples(uint8_t filterCoefficient);
+
+// Switch the sensor to a profile and measure it. The sensor must not be
+// sampled by anything else meanwhile (pause the Sampler first).
+SensorProfileStats measureSensorProfile(Sensor& sensor, SensorProfile profile);
+
+// Measure every profile, print a table over Serial, then restore the
+// profile that was active before
+void reportSensorProfiles(Sensor& sensor);
+
+#endif // SENSOR_PROFILE_H
@@ -0,0 +1,166 @@
+#include "SessionLog.h"
+#include "Crc32.h"
+#include "LatencyTrace.h"
+#include "Storage.h"
+#include <Arduino.h>
+
+static const uint32_t RECORD_SIZE = 32;
+static const uint32_t SLOTS_PER_SECTOR = Storage::LOG_SECTOR_SIZE / RECORD_SIZE;
+
+void SessionLog::init() {
+  static_assert(sizeof(Record) == RECORD_SIZE, "Session records must stay 32 bytes");
+
+  slotCount = storage.getLogSize() / RECORD_SIZE;
+  if (slotCount == 0) {
+    Serial.println("Session log: no flash region, summaries are not stored");
+    return;
+  }
+
+  // Continue after the newest record (sequence numbers may wrap)
+  Record record;
+  uint32_t newestSlot = 0;
+  bool found = false;
+  for (uint32_t slot = 0; slot < slotCount; slot++) {
+    if (!readRecord(slot, record)) continue;
+    if (!found || (int32_t)(record.sequence - nextSequence) >= 0) {
+      newestSlot = slot;
+      nextSequence = record.sequence + 1;
+      found = true;
+    }
+  }
+  nextSlot = found ? (newestSlot + 1) % slotCount : 0;
+
+  Serial.print("Session log: ");
+  Serial.print((int)(slotCount / SLOTS_PER_SECTOR));
+  Serial.print(" sectors, next record ");
+  Serial.println((int)nextSequence);
+
+  // Nothing is sampled yet
+  prepareNextSector();
+}
+
+bool SessionLog::enqueue(const SessionSummary& summary) {
+  if (queue.push(summary)) return true;
+  dropped++;
+  return false;
+}
+
+void SessionLog::flush() {
+  SessionSummary summary;
+  bool appended = false;
+  while (queue.pop(summary)) {
+    uint32_t start = micros();
+    append(summary);
+    uint32_t elapsed = micros() - start;
+    if (elapsed > maxWriteMicros) maxWriteMicros = elapsed;
+    appended = true;
+  }
+
+  // A session just ended: erase the next sector before another one starts
+  if (appended) prepareNextSector();
+
+  if (reportRequested.exchange(false)) report();
+}
+
+void SessionLog::append(const SessionSummary& summary) {
+  if (slotCount == 0) return;
+
+  uint32_t slot = nextSlot;
+  if (slot % SLOTS_PER_SECTOR == 0 && slot != preparedSlot) {
+    // Entering a sector that was not erased ahead (its records are the
+    // oldest in the ring)
+    if (!eraseSector(slot)) return;
+    lateErases++;
+  } else if (!isErased(slot)) {
+    // Left half-written by a power loss: start on the next sector
+    nextSlot = (slot / SLOTS_PER_SECTOR + 1) * SLOTS_PER_SECTOR % slotCount;
+    append(summary);
+    return;
+  }
+
+  Record record;
+  record.sequence = nextSequence;
+  record.summary = summary;
+  record.crc = crc32(&record, offsetof(Record, crc));
+  uint32_t start = micros();
+  bool stored = storage.writeLog(slot * RECORD_SIZE, &record, sizeof(record));
+  latencyTrace.noteFlashStall(micros() - start);
+  if (!stored) {
+    failures++;
+    return;
+  }
+
+  nextSlot = (slot + 1) % slotCount;
+  nextSequence++;
+  written++;
+  preparedSlot = UINT32_MAX;
+}
+
+bool SessionLog::eraseSector(uint32_t slot) {
+  uint32_t start = micros();
+  bool erased = storage.eraseLogSector(slot * RECORD_SIZE);
+  latencyTrace.noteFlashStall(micros() - start);
+  if (!erased) {
+    failures++;
+    return false;
+  }
+  erases++;
+  return true;
+}
+
+// Erase the sector the next record opens, if it opens one
+void SessionLog::prepareNextSector() {
+  if (slotCount == 0 || nextSlot % SLOTS_PER_SECTOR != 0 || nextSlot == preparedSlot) return;
+  if (eraseSector(nextSlot)) preparedSlot = nextSlot;
+}
+
+bool SessionLog::readRecord(uint32_t slot, Record& record) const {
+  return storage.readLog(slot * RECORD_SIZE, &record, sizeof(record)) &&
+         record.crc == crc32(&record, offsetof(Record, crc));
+}
+
+bool SessionLog::isErased(uint32_t slot) const {
+  uint8_t bytes[RECORD_SIZE];
+  if (!storage.readLog(slot * RECORD_SIZE, bytes, sizeof(bytes))) return false;
+  for (uint32_t i = 0; i < RECORD_SIZE; i++) {
+    if (bytes[i] != 0xFF) return false;
+  }
+  return true;
+}
+
+void SessionLog::report() {
+  Serial.print("Session log: ");
+  Serial.print((int)written);
+  Serial.print(" written, ");
+  Serial.print((int)dropped.load());
+  Serial.print(" dropped, ");
+  Serial.print((int)erases);
+  Serial.print(" sector erases (");
+  Serial.print((int)lateErases);
+  Serial.print(" while appending), ");
+  Serial.print((int)failures);
+  Serial.print(" failures, write max ");
+  Serial.print(maxWriteMicros / 1000.0f, 1);
+  Serial.println(" ms");
+
+  // Ring order from the oldest slot is sequence order
+  Serial.println("sequence,duration_s,breaths,rate_mean_bpm,rate_median_bpm,rate_min_bpm,rate_max_bpm");
+  Record record;
+  for (uint32_t i = 0; i < slotCount; i++) {
+    if (!readRecord((nextSlot + i) % slotCount, record)) continue;
+    const SessionSummary& summary = record.summary;
+    Serial.print((int)record.sequence);
+    Serial.print(",");
+    Serial.print(summary.durationMs / 1000.0f, 1);
+    Serial.print(",");
+    Serial.print((int)summary.breathCount);
+    Serial.print(",");
+    Serial.print(summary.meanRateBpm, 2);
+    Serial.print(",");
+    Serial.print(summary.medianRateBpm, 2);
+    Serial.print(",");
+    Serial.print(summary.minRateBpm, 2);
+    Serial.print(",");
+    Serial.println(summary.maxRateBpm, 2);
+  }
+}
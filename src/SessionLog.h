@@ -0,0 +1,91 @@
+#ifndef SESSION_LOG_H
+#define SESSION_LOG_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "SampleRing.h"
+
+// One finished breathing session. Rates come from the breath cycle
+// durations (60000 / cycle ms).
+struct SessionSummary {
+  uint32_t durationMs;   // First breath's start to the last breath's end
+  uint16_t breathCount;
+  uint16_t reserved;
+  float meanRateBpm;
+  float medianRateBpm;
+  float minRateBpm;
+  float maxRateBpm;
+};
+
+// Write-behind log of session summaries on flash. The detection task
+// queues finished sessions in RAM and never waits: when the queue is
+// full the summary is dropped and counted. A low-priority storage task
+// appends queued summaries to the log region (see Storage).
+//
+// The region is a ring of flash sectors filled record by record. A
+// sector is erased only when the ring is about to enter it, so every
+// sector is erased equally often (wear leveling). Records carry a
+// sequence number and a CRC: init() finds the newest, and a record torn
+// by power loss fails its CRC and is skipped.
+//
+// An erase stalls both ESP32 cores, sampling and detection included, for
+// tens of ms. So the next sector is erased ahead of time, at boot and
+// right after a session's summary is written (no one is breathing then),
+// and never while appending unless that failed.
+
+class SessionLog {
+public:
+  // Find where the log continues (after storage.init())
+  void init();
+
+  // Detection side: queue a summary. False (dropped) when the queue is full.
+  bool enqueue(const SessionSummary& summary);
+
+  // Storage task: write the queued summaries, then print a requested report
+  void flush();
+
+  // Any task: print the log at the next flush()
+  void requestReport() { reportRequested.store(true); }
+
+  // Storage task: counters, then the stored summaries oldest first as CSV
+  void report();
+
+  unsigned long getWrittenCount() const { return written; }
+  unsigned long getDroppedCount() const { return dropped.load(); }
+
+private:
+  struct Record {
+    uint32_t sequence;
+    SessionSummary summary;
+    uint32_t crc;  // Of sequence and summary
+  };
+
+  // Valid record in a slot
+  bool readRecord(uint32_t slot, Record& record) const;
+  bool isErased(uint32_t slot) const;
+  void append(const SessionSummary& summary);
+  bool eraseSector(uint32_t slot);
+  void prepareNextSector();
+
+  SampleRing<SessionSummary, SESSION_QUEUE_SIZE> queue;
+  std::atomic<unsigned long> dropped{0};
+  std::atomic<bool> reportRequested{false};
+
+  // Storage task only
+  uint32_t slotCount = 0;    // 0 without a log region
+  uint32_t nextSlot = 0;
+  uint32_t nextSequence = 1;
+  uint32_t preparedSlot = UINT32_MAX;  // First slot of a sector erased ahead
+  unsigned long written = 0;
+  unsigned long erases = 0;
+  unsigned long lateErases = 0;        // Erased while appending instead
+  unsigned long failures = 0;
+  uint32_t maxWriteMicros = 0;
+};
+
+// Global session log (defined in main.cpp)
+extern SessionLog sessionLog;
+
+#endif // SESSION_LOG_H
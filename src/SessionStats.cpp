@@ -0,0 +1,180 @@
+#include "SessionStats.h"
+#include <math.h>
+#include <string.h>
+
+void RunningStats::reset() {
+  count = 0;
+  mean = 0;
+  m2 = 0;
+  minValue = 0;
+  maxValue = 0;
+}
+
+void RunningStats::add(float value) {
+  count++;
+  double delta = value - mean;
+  mean += delta / count;
+  m2 += delta * (value - mean);
+
+  if (count == 1 || value < minValue) minValue = value;
+  if (count == 1 || value > maxValue) maxValue = value;
+}
+
+float RunningStats::getStdDev() const {
+  return count > 1 ? (float)sqrt(m2 / (count - 1)) : 0.0f;
+}
+
+void P2Quantile::reset() {
+  count = 0;
+  for (int i = 0; i < 5; i++) {
+    heights[i] = 0;
+    positions[i] = i + 1;
+  }
+  desired[0] = 1;
+  desired[1] = 1 + 2 * p;
+  desired[2] = 1 + 4 * p;
+  desired[3] = 3 + 2 * p;
+  desired[4] = 5;
+  increments[0] = 0;
+  increments[1] = p / 2;
+  increments[2] = p;
+  increments[3] = (1 + p) / 2;
+  increments[4] = 1;
+}
+
+void P2Quantile::add(float value) {
+  // Collect the first five values in sorted order
+  if (count < 5) {
+    int i = count++;
+    while (i > 0 && heights[i - 1] > value) {
+      heights[i] = heights[i - 1];
+      i--;
+    }
+    heights[i] = value;
+    return;
+  }
+  count++;
+
+  // Cell containing the value, extending the extremes if needed
+  int cell;
+  if (value < heights[0]) {
+    heights[0] = value;
+    cell = 0;
+  } else if (value >= heights[4]) {
+    if (value > heights[4]) heights[4] = value;
+    cell = 3;
+  } else {
+    cell = 0;
+    while (cell < 3 && value >= heights[cell + 1]) cell++;
+  }
+
+  for (int i = cell + 1; i < 5; i++) {
+    positions[i] += 1;
+  }
+  for (int i = 0; i < 5; i++) {
+    desired[i] += increments[i];
+  }
+
+  // Move the middle markers toward their desired positions
+  for (int i = 1; i < 4; i++) {
+    float offset = desired[i] - positions[i];
+    if ((offset >= 1 && positions[i + 1] - positions[i] > 1) ||
+        (offset <= -1 && positions[i - 1] - positions[i] < -1)) {
+      int d = offset > 0 ? 1 : -1;
+      float height = parabolic(i, d);
+      if (heights[i - 1] < height && height < heights[i + 1]) {
+        heights[i] = height;
+      } else {
+        heights[i] = linear(i, d);
+      }
+      positions[i] += d;
+    }
+  }
+}
+
+float P2Quantile::parabolic(int i, int d) const {
+  return heights[i] + d / (positions[i + 1] - positions[i - 1]) *
+         ((positions[i] - positions[i - 1] + d) * (heights[i + 1] - heights[i]) /
+              (positions[i + 1] - positions[i]) +
+          (positions[i + 1] - positions[i] - d) * (heights[i] - heights[i - 1]) /
+              (positions[i] - positions[i - 1]));
+}
+
+float P2Quantile::linear(int i, int d) const {
+  return heights[i] + d * (heights[i + d] - heights[i]) / (positions[i + d] - positions[i]);
+}
+
+float P2Quantile::get() const {
+  if (count == 0) return 0;
+  if (count <= 5) {
+    // Exact quantile of the sorted values collected so far
+    int index = (int)(p * (count - 1) + 0.5f);
+    return heights[index];
+  }
+  return heights[2];
+}
+
+void MetricStats::reset() {
+  stats.reset();
+  median.reset();
+  p90.reset();
+}
+
+void MetricStats::add(float value) {
+  stats.add(value);
+  median.add(value);
+  p90.add(value);
+}
+
+void SessionStats::reset() {
+  cycleDuration.reset();
+  inhaleDuration.reset();
+  exhaleDuration.reset();
+  holdDuration.reset();
+  depth.reset();
+  inhaleRatio.reset();
+}
+
+void SessionStats::add(const BreathCycle& cycle) {
+  cycleDuration.add(cycle.durationMs);
+  inhaleDuration.add(cycle.inhaleMs);
+  exhaleDuration.add(cycle.exhaleMs);
+  holdDuration.add(cycle.holdMs);
+  depth.add(cycle.depthPa);
+
+  unsigned long breathingMs = cycle.inhaleMs + cycle.exhaleMs;
+  if (breathingMs > 0) {
+    inhaleRatio.add((float)cycle.inhaleMs / breathingMs);
+  }
+}
+
+static void printMetric(const char* name, const MetricStats& metric, int decimals) {
+  Serial.print(name);
+  for (int pad = strlen(name); pad < 10; pad++) Serial.print(" ");
+  Serial.print(metric.getMean(), decimals);
+  Serial.print("  ");
+  Serial.print(metric.getStdDev(), decimals);
+  Serial.print("  ");
+  Serial.print(metric.getMedian(), decimals);
+  Serial.print("  ");
+  Serial.print(metric.getP90(), decimals);
+  Serial.print("  ");
+  Serial.print(metric.getMin(), decimals);
+  Serial.print("  ");
+  Serial.println(metric.getMax(), decimals);
+}
+
+void reportSessionStats(const SessionStats& stats) {
+  Serial.print("Session: ");
+  Serial.print((int)stats.getBreathCount());
+  Serial.println(" breaths");
+  if (stats.getBreathCount() == 0) return;
+
+  Serial.println("Metric    Mean  SD  Median  P90  Min  Max");
+  printMetric("cycle ms", stats.getCycleDuration(), 0);
+  printMetric("inhale ms", stats.getInhaleDuration(), 0);
+  printMetric("exhale ms", stats.getExhaleDuration(), 0);
+  printMetric("hold ms", stats.getHoldDuration(), 0);
+  printMetric("depth Pa", stats.getDepth(), 1);
+  printMetric("in ratio", stats.getInhaleRatio(), 2);
+}
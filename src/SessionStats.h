@@ -0,0 +1,111 @@
+#ifndef SESSION_STATS_H
+#define SESSION_STATS_H
+
+#include "config.h"
+
+// Streaming mean/variance (Welford). Accumulates in double so long
+// sessions do not drift; updated once per breath, so the cost is small
+// even with software doubles on the ESP32.
+class RunningStats {
+public:
+  void reset();
+  void add(float value);
+
+  unsigned long getCount() const { return count; }
+  float getMean() const { return (float)mean; }
+  float getStdDev() const;
+  float getMin() const { return minValue; }
+  float getMax() const { return maxValue; }
+
+private:
+  unsigned long count = 0;
+  double mean = 0;
+  double m2 = 0;
+  float minValue = 0;
+  float maxValue = 0;
+};
+
+// Streaming quantile estimate with five markers (Jain & Chlamtac P^2).
+// Fixed memory, O(1) per value, exact for the first five values.
+class P2Quantile {
+public:
+  explicit P2Quantile(float p = 0.5f) : p(p) { reset(); }
+
+  void reset();
+  void add(float value);
+  float get() const;
+
+private:
+  // Piecewise-parabolic prediction for moving marker i by d (+1 or -1)
+  float parabolic(int i, int d) const;
+  float linear(int i, int d) const;
+
+  float p;
+  unsigned long count;
+  float heights[5];
+  float positions[5];
+  float desired[5];
+  float increments[5];
+};
+
+// Mean, spread, extremes and median/p90 of one per-breath quantity
+class MetricStats {
+public:
+  MetricStats() : median(0.5f), p90(0.9f) {}
+
+  void reset();
+  void add(float value);
+
+  unsigned long getCount() const { return stats.getCount(); }
+  float getMean() const { return stats.getMean(); }
+  float getStdDev() const { return stats.getStdDev(); }
+  float getMin() const { return stats.getMin(); }
+  float getMax() const { return stats.getMax(); }
+  float getMedian() const { return median.get(); }
+  float getP90() const { return p90.get(); }
+
+private:
+  RunningStats stats;
+  P2Quantile median;
+  P2Quantile p90;
+};
+
+// One completed breath cycle (inhale start to the next inhale start)
+struct BreathCycle {
+  unsigned long durationMs;
+  unsigned long inhaleMs;   // Time in BREATH_INHALE
+  unsigned long exhaleMs;   // Time in BREATH_EXHALE
+  unsigned long holdMs;     // Time in BREATH_HOLD
+  float depthPa;            // Peak-to-peak pressure swing
+};
+
+// Fixed-memory statistics over every breath of a session
+class SessionStats {
+public:
+  void reset();
+  void add(const BreathCycle& cycle);
+
+  unsigned long getBreathCount() const { return cycleDuration.getCount(); }
+
+  const MetricStats& getCycleDuration() const { return cycleDuration; }
+  const MetricStats& getInhaleDuration() const { return inhaleDuration; }
+  const MetricStats& getExhaleDuration() const { return exhaleDuration; }
+  const MetricStats& getHoldDuration() const { return holdDuration; }
+  const MetricStats& getDepth() const { return depth; }
+
+  // Inhale share of inhale + exhale time (0-1)
+  const MetricStats& getInhaleRatio() const { return inhaleRatio; }
+
+private:
+  MetricStats cycleDuration;
+  MetricStats inhaleDuration;
+  MetricStats exhaleDuration;
+  MetricStats holdDuration;
+  MetricStats depth;
+  MetricStats inhaleRatio;
+};
+
+// Print a table of session statistics over Serial
+void reportSessionStats(const SessionStats& stats);
+
+#endif // SESSION_STATS_H
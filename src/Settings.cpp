@@ -0,0 +1,176 @@
+#include <math.h>
+#include <string.h>
+#include "Settings.h"
+#include "Crc32.h"
+#include "LatencyTrace.h"
+#include "Storage.h"
+#include <Arduino.h>
+
+static const uint32_t SETTINGS_MAGIC = 0x54455349;  // "ISET"
+
+Settings defaultSettings() {
+  Settings settings = {};
+  settings.inhaleThreshold = DEFAULT_INHALE_THRESHOLD;
+  settings.exhaleThreshold = DEFAULT_EXHALE_THRESHOLD;
+  settings.sensorProfile = DEFAULT_SENSOR_PROFILE;
+  settings.mode = MODE_LIVE;
+  settings.minDelta = DEFAULT_MIN_DELTA;
+  settings.maxDelta = DEFAULT_MAX_DELTA;
+  return settings;
+}
+
+// A bound the detector keeps as it is (see BreathDetector::setMinDelta)
+static bool isUsableBound(float magnitude) {
+  return magnitude >= BOUND_MIN_PA && magnitude <= BOUND_MAX_PA;
+}
+
+// Replace values this firmware cannot use with their defaults
+static void sanitize(Settings& settings) {
+  const Settings defaults = defaultSettings();
+  if (!isfinite(settings.inhaleThreshold) || !isfinite(settings.exhaleThreshold)) {
+    settings.inhaleThreshold = defaults.inhaleThreshold;
+    settings.exhaleThreshold = defaults.exhaleThreshold;
+  }
+  if (settings.sensorProfile >= SENSOR_PROFILE_COUNT) settings.sensorProfile = defaults.sensorProfile;
+  if (settings.mode > MODE_DIAGNOSTIC) settings.mode = defaults.mode;
+  if (!isUsableBound(-settings.minDelta) || !isUsableBound(settings.maxDelta)) {
+    settings.minDelta = defaults.minDelta;
+    settings.maxDelta = defaults.maxDelta;
+  }
+}
+
+const Settings& SettingsStore::load() {
+  static_assert(sizeof(Settings) == 20, "Settings fields must pack without padding");
+  static_assert(sizeof(Header) + sizeof(Settings) + sizeof(uint32_t) <= MAX_RECORD_SIZE,
+                "Settings record outgrew MAX_RECORD_SIZE");
+
+  Settings settings = defaultSettings();
+  const char* source = "defaults";
+  bool migrated = false;
+  if (readRecord(settings)) {
+    source = "record";
+  } else if (storage.readLegacyCalibration(settings.inhaleThreshold, settings.exhaleThreshold)) {
+    source = "migrated calibration";
+    migrated = true;
+  }
+  sanitize(settings);
+
+  // Version 0: keep the old keys until the record holding them is written
+  if (migrated && commit(settings)) {
+    commits++;
+    storage.removeLegacyCalibration();
+  }
+
+  current = settings;
+  committed = settings;
+  pending = settings;
+  published.edit() = settings;
+  published.publish();
+
+  Serial.print("Loaded settings (");
+  Serial.print(source);
+  Serial.print(") - Inhale: ");
+  Serial.print(settings.inhaleThreshold);
+  Serial.print(" Pa, Exhale: ");
+  Serial.print(settings.exhaleThreshold);
+  Serial.print(" Pa, Bounds: ");
+  Serial.print(settings.minDelta);
+  Serial.print("..");
+  Serial.print(settings.maxDelta);
+  Serial.println(" Pa");
+  return current;
+}
+
+bool SettingsStore::readRecord(Settings& settings) {
+  uint8_t record[MAX_RECORD_SIZE];
+  size_t size = storage.readSettings(record, sizeof(record));
+  if (size < sizeof(Header) + sizeof(uint32_t)) return false;
+
+  Header header;
+  memcpy(&header, record, sizeof(header));
+  size_t payloadEnd = sizeof(header) + header.size;
+  if (header.magic != SETTINGS_MAGIC || header.version == 0 ||
+      payloadEnd + sizeof(uint32_t) != size) {
+    return false;
+  }
+
+  uint32_t crc;
+  memcpy(&crc, record + payloadEnd, sizeof(crc));
+  if (crc != crc32(record, payloadEnd)) return false;
+
+  // Older records are a prefix of Settings (the rest keeps its defaults);
+  // a newer firmware's record is read as far as this one knows it
+  size_t known = header.size < sizeof(Settings) ? header.size : sizeof(Settings);
+  memcpy(&settings, record + sizeof(header), known);
+  return true;
+}
+
+bool SettingsStore::commit(const Settings& settings) {
+  uint8_t record[sizeof(Header) + sizeof(Settings) + sizeof(uint32_t)];
+  Header header = { SETTINGS_MAGIC, SETTINGS_VERSION, (uint16_t)sizeof(Settings) };
+  memcpy(record, &header, sizeof(header));
+  memcpy(record + sizeof(header), &settings, sizeof(settings));
+  uint32_t crc = crc32(record, sizeof(header) + sizeof(settings));
+  memcpy(record + sizeof(header) + sizeof(settings), &crc, sizeof(crc));
+  uint32_t start = micros();
+  bool stored = storage.writeSettings(record, sizeof(record));
+  latencyTrace.noteFlashStall(micros() - start);
+  return stored;
+}
+
+void SettingsStore::update(const Settings& settings) {
+  if (memcmp(&settings, &current, sizeof(Settings)) == 0) return;
+  current = settings;
+  published.edit() = settings;
+  published.publish();
+}
+
+// Take the newest published settings, timing the quiet period from
+// the last change seen
+void SettingsStore::collect(unsigned long now) {
+  const Settings& latest = published.read();
+  if (memcmp(&latest, &pending, sizeof(Settings)) == 0) return;
+  pending = latest;
+  if (!dirty) firstChangeMillis = now;
+  lastChangeMillis = now;
+  dirty = true;
+  changes++;
+}
+
+void SettingsStore::commitIfQuiet(unsigned long now) {
+  collect(now);
+  if (!dirty) return;
+  if (now - lastChangeMillis < SETTINGS_QUIET_MS &&
+      now - firstChangeMillis < SETTINGS_MAX_DEFER_MS) {
+    return;
+  }
+  flush();
+}
+
+void SettingsStore::flush() {
+  collect(millis());
+  if (!dirty) return;
+
+  // Changed back to what is stored: nothing to write
+  if (memcmp(&pending, &committed, sizeof(Settings)) != 0) {
+    if (!commit(pending)) {
+      // Retry after another quiet period
+      failures++;
+      firstChangeMillis = lastChangeMillis = millis();
+      return;
+    }
+    committed = pending;
+    commits++;
+  }
+  dirty = false;
+}
+
+void SettingsStore::report() const {
+  Serial.print("Settings: ");
+  Serial.print((int)changes);
+  Serial.print(" changes, ");
+  Serial.print((int)commits);
+  Serial.print(" commits, ");
+  Serial.print((int)failures);
+  Serial.println(" failures");
+}
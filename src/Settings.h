@@ -0,0 +1,88 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "SnapshotBuffer.h"
+
+// Every persistent setting. The layout is the stored record's payload:
+// fields are only ever appended (bump SETTINGS_VERSION), so an older
+// record is a prefix of this one and newer fields keep their defaults.
+struct Settings {
+  // Version 1
+  float inhaleThreshold;  // Calibration thresholds (Pa)
+  float exhaleThreshold;
+  uint8_t sensorProfile;  // SensorProfile
+  uint8_t mode;           // AppMode shown at boot
+  uint8_t reserved[2];
+  float minDelta;         // Learned normalization bounds (Pa)
+  float maxDelta;
+};
+
+// Built-in values, used for anything a stored record does not have
+Settings defaultSettings();
+
+// Persistent settings as one record: magic, version, payload size, the
+// Settings payload and a CRC-32, stored under a single NVS key. load()
+// reads it once at boot, migrating older records (version 0 is the
+// per-key calibration written before this record existed).
+//
+// Changes are coalesced in RAM. The render side publishes the current
+// settings every frame; only a change is passed on, and the storage task
+// commits once they have been unchanged for SETTINGS_QUIET_MS (or
+// SETTINGS_MAX_DEFER_MS after the first change, for settings that keep
+// changing), so a burst of changes costs one flash write.
+class SettingsStore {
+public:
+  // Read, check and migrate the stored record (after storage.init()).
+  // Returns the settings to apply: defaults when none are stored.
+  const Settings& load();
+
+  // Render side: the settings last loaded or updated
+  const Settings& get() const { return current; }
+
+  // Render side: note the current settings (cheap when unchanged)
+  void update(const Settings& settings);
+
+  // Storage task: commit once changes have settled
+  void commitIfQuiet(unsigned long now);
+
+  // Storage task: commit pending changes now
+  void flush();
+
+  // Storage task: counters
+  void report() const;
+
+private:
+  struct Header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;     // Payload bytes
+  };
+
+  static const size_t MAX_RECORD_SIZE = 128;
+
+  bool readRecord(Settings& settings);
+  bool commit(const Settings& settings);
+  void collect(unsigned long now);
+
+  // Render side
+  Settings current = {};
+  SnapshotBuffer<Settings> published;
+
+  // Storage task only
+  Settings committed = {};
+  Settings pending = {};
+  bool dirty = false;
+  unsigned long firstChangeMillis = 0;
+  unsigned long lastChangeMillis = 0;
+  unsigned long changes = 0;
+  unsigned long commits = 0;
+  unsigned long failures = 0;
+};
+
+// Global settings store (defined in main.cpp)
+extern SettingsStore settingsStore;
+
+#endif // SETTINGS_H
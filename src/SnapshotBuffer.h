@@ -0,0 +1,42 @@
+#ifndef SNAPSHOT_BUFFER_H
+#define SNAPSHOT_BUFFER_H
+
+#include <atomic>
+#include <stdint.h>
+
+// Lock-free triple buffer: one task publishes whole values, one other
+// task reads the newest one. The writer fills its own slot and swaps it
+// with the shared middle slot; the reader swaps the middle slot for its
+// own only when something new was published. Neither side ever waits,
+// and the reader never sees a half-written value.
+template <typename T>
+class SnapshotBuffer {
+public:
+  // Producer side: the slot to fill before publish()
+  T& edit() { return slots[back]; }
+
+  // Producer side: make the edited slot the newest value
+  void publish() {
+    back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+  }
+
+  // Consumer side: the newest published value. The reference stays
+  // valid (and unchanged) until the next read().
+  const T& read() {
+    if (middle.load(std::memory_order_relaxed) & FRESH) {
+      front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+    }
+    return slots[front];
+  }
+
+private:
+  static const uint8_t INDEX = 0x03;
+  static const uint8_t FRESH = 0x04;  // Middle slot not read yet
+
+  T slots[3] = {};
+  std::atomic<uint8_t> middle{1};
+  uint8_t back = 2;   // Producer's slot
+  uint8_t front = 0;  // Consumer's slot
+};
+
+#endif // SNAPSHOT_BUFFER_H
@@ -2,37 +2,59 @@
 #include "config.h"
 #include <Preferences.h>
 #include <Arduino.h>
+#include <esp_partition.h>
 
 static Preferences preferences;
 
+// Session log region: the start of the default partition table's data
+// partition (labelled spiffs; no filesystem is mounted on it)
+static const esp_partition_t* logPartition = nullptr;
+
 void Storage::init() {
   preferences.begin("inhale", false);
+  logPartition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                          ESP_PARTITION_SUBTYPE_DATA_SPIFFS, nullptr);
   Serial.println("NVS storage initialized");
+  if (!logPartition) Serial.println("No data partition for the session log");
+}
+
+size_t Storage::readSettings(void* data, size_t capacity) {
+  size_t size = preferences.getBytesLength("settings");
+  if (size == 0 || size > capacity) return 0;
+  return preferences.getBytes("settings", data, size);
+}
+
+bool Storage::writeSettings(const void* data, size_t size) {
+  return preferences.putBytes("settings", data, size) == size;
 }
 
-void Storage::loadCalibration(float& inhaleThreshold, float& exhaleThreshold) {
-  if (preferences.isKey("inhaleThresh")) {
-    inhaleThreshold = preferences.getFloat("inhaleThresh");
-  } else {
-    inhaleThreshold = DEFAULT_INHALE_THRESHOLD;
-  }
+bool Storage::readLegacyCalibration(float& inhaleThreshold, float& exhaleThreshold) {
+  if (!preferences.isKey("inhaleThresh") && !preferences.isKey("exhaleThresh")) return false;
+  inhaleThreshold = preferences.getFloat("inhaleThresh", DEFAULT_INHALE_THRESHOLD);
+  exhaleThreshold = preferences.getFloat("exhaleThresh", DEFAULT_EXHALE_THRESHOLD);
+  return true;
+}
 
-  if (preferences.isKey("exhaleThresh")) {
-    exhaleThreshold = preferences.getFloat("exhaleThresh");
-  } else {
-    exhaleThreshold = DEFAULT_EXHALE_THRESHOLD;
-  }
+void Storage::removeLegacyCalibration() {
+  preferences.remove("inhaleThresh");
+  preferences.remove("exhaleThresh");
+}
 
-  Serial.print("Loaded calibration - Inhale: ");
-  Serial.print(inhaleThreshold);
-  Serial.print(" Pa, Exhale: ");
-  Serial.print(exhaleThreshold);
-  Serial.println(" Pa");
+uint32_t Storage::getLogSize() const {
+  if (!logPartition) return 0;
+  uint32_t size = SESSION_LOG_SECTORS * LOG_SECTOR_SIZE;
+  if (logPartition->size < size) size = logPartition->size / LOG_SECTOR_SIZE * LOG_SECTOR_SIZE;
+  return size;
 }
 
-void Storage::saveCalibration(float inhaleThreshold, float exhaleThreshold) {
-  preferences.putFloat("inhaleThresh", inhaleThreshold);
-  preferences.putFloat("exhaleThresh", exhaleThreshold);
+bool Storage::eraseLogSector(uint32_t offset) {
+  return esp_partition_erase_range(logPartition, offset, LOG_SECTOR_SIZE) == ESP_OK;
+}
+
+bool Storage::writeLog(uint32_t offset, const void* data, size_t size) {
+  return esp_partition_write(logPartition, offset, data, size) == ESP_OK;
+}
 
-  Serial.println("Calibration saved to NVS");
+bool Storage::readLog(uint32_t offset, void* data, size_t size) const {
+  return esp_partition_read(logPartition, offset, data, size) == ESP_OK;
 }
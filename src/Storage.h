@@ -1,16 +1,47 @@
 #ifndef STORAGE_H
 #define STORAGE_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 class Storage {
 public:
-  // Initialize NVS storage
+  // Initialize NVS storage and find the session log region
   void init();
 
-  // Load calibration values from NVS
-  void loadCalibration(float& inhaleThreshold, float& exhaleThreshold);
+  // Settings record (see SettingsStore), stored whole under one NVS key.
+  // Returns its size: 0 when none is stored or it exceeds capacity.
+  size_t readSettings(void* data, size_t capacity);
+  bool writeSettings(const void* data, size_t size);
+
+  // Calibration thresholds as separate NVS keys, stored before the
+  // settings record (false when there are none)
+  bool readLegacyCalibration(float& inhaleThreshold, float& exhaleThreshold);
+  void removeLegacyCalibration();
+
+  // Raw flash region for SessionLog (ESP32: the data partition of the
+  // default partition table, simulator: RAM or a file). Erased bytes read
+  // 0xFF and writes can only clear bits, so each byte is written once per
+  // erase. Offsets are from the start of the region.
+  static const uint32_t LOG_SECTOR_SIZE = 4096;
+
+  // Bytes in the region, a whole number of sectors (0 when there is none)
+  uint32_t getLogSize() const;
+
+  bool eraseLogSector(uint32_t offset);
+  bool writeLog(uint32_t offset, const void* data, size_t size);
+  bool readLog(uint32_t offset, void* data, size_t size) const;
+
+#ifdef SIMULATOR
+  // Simulator only: keep the log region and settings in a file across
+  // runs (call before init())
+  void useFile(const char* path);
 
-  // Save calibration values to NVS
-  void saveCalibration(float inhaleThreshold, float exhaleThreshold);
+  // Simulator only: stall each write and sector erase like flash does
+  // (real sleeps on the storage thread; HEADLESS advances the virtual
+  // clock, as when a flash operation pauses both ESP32 cores)
+  void setLatency(uint32_t writeMs, uint32_t eraseMs);
+#endif
 };
 
 // Global storage instance (defined in main.cpp)
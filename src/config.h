@@ -26,6 +26,17 @@
 // Custom color definitions (not in all ST7735 library versions)
 #define ST77XX_GRAY   0x8410  // RGB(128, 128, 128)
 
+// Strip buffers and blit
+#define DISPLAY_STRIP_ROWS    16   // Frame rows drawn and sent at a time (divides SCREEN_HEIGHT)
+#define DISPLAY_BUFFERS       2    // Ping-pong strip buffers
+#define DISPLAY_INDEXED_COLOR 1    // 8-bit strips with per-mode palettes (2 KB instead of 4 KB each)
+#define DISPLAY_ASYNC_BLIT    1    // Transfer on a background task while the next strip renders
+#define BLIT_TASK_CORE        0    // ESP32: shares core 0 with the (higher priority) sampler and detection
+#define BLIT_TASK_PRIORITY    1
+#define BLIT_MAX_SPANS        8    // Address windows per strip
+#define BLIT_MERGE_GAP_ROWS   2    // Resend clean gaps up to this many rows
+#define RASTER_PAIR_WRITES    1    // Fill 16-bit spans with aligned 32-bit stores
+
 // ========================================
 // Application Modes
 // ========================================
@@ -47,17 +58,100 @@ enum BreathState {
 // Default calibration thresholds (Pa)
 #define DEFAULT_INHALE_THRESHOLD  -5.0f
 #define DEFAULT_EXHALE_THRESHOLD   5.0f
+
+// Initial normalization bounds (Pa), widened as breaths exceed them
+#define DEFAULT_MIN_DELTA        -10.0f
+#define DEFAULT_MAX_DELTA         10.0f
+// Bound magnitudes are kept in this range (Pa): the reciprocal of the
+// smallest and the overage of the largest must fit Q16.16
+#define BOUND_MIN_PA               0.1f
+#define BOUND_MAX_PA            4000.0f
 #define BREATH_HOLD_TIMEOUT_MS     3000
 #define BREATH_HOLD_STABILITY_PA   2.0f
+#define BREATH_CYCLE_MAX_MS        60000  // Longer cycles are pauses, not breaths
+#define BREATH_LOG_SIZE            2048   // Breaths kept in RAM (8 bytes each)
 
 // Normalization overage threshold (1.1 = 10% beyond bounds before expanding)
 #define NORM_OVERAGE_THRESHOLD     1.25f
 
+// Detection math in Q16.16 fixed point (1) or float (0)
+#define BREATH_FIXED_POINT         1
+
+// Breathing rate estimate (sliding DFT over decimated samples)
+#define RATE_DECIMATE_MS           250   // Bucket length (4 Hz)
+#define RATE_WINDOW                128   // Buckets in the DFT window (32 s)
+#define RATE_MIN_BPM               4.0f
+#define RATE_MAX_BPM               40.0f
+#define RATE_MIN_CONFIDENCE        0.5f  // Below this the rate is shown as unknown
+
+// ========================================
+// Sensor Profiles
+// ========================================
+// BMP280 oversampling/IIR presets, trading latency against noise
+enum SensorProfile {
+  SENSOR_PROFILE_LOW_LATENCY,
+  SENSOR_PROFILE_BALANCED,
+  SENSOR_PROFILE_LOW_NOISE,
+  SENSOR_PROFILE_COUNT
+};
+
+#define DEFAULT_SENSOR_PROFILE    SENSOR_PROFILE_LOW_LATENCY  // PressureFilter does the smoothing
+#define PROFILE_SETTLE_MS         500   // Discard readings after switching
+#define PROFILE_MEASURE_MS        2000  // Window for rate/noise measurement
+
 // ========================================
 // Update Rates
 // ========================================
-#define MAIN_LOOP_DELAY_MS        20    // ~50Hz
+// Periodic tasks (see Scheduler.h); sampling has its own task
+#define DETECT_PERIOD_MS          20    // Drain, filter and detect at 50Hz
+#define DETECT_TASK_CORE           0    // ESP32: rendering stays in loop() on core 1
+#define DETECT_TASK_PRIORITY       2    // Below the sampler, above the blit
 #define WAVE_UPDATE_FPS           30
 #define DIAGNOSTIC_UPDATE_FPS     10
+#define SCHEDULER_MAX_TASKS       6
+
+// ========================================
+// Sampling
+// ========================================
+#define SAMPLE_PERIOD_MS          10    // ~100Hz sensor sampling task
+#define SAMPLE_RING_SIZE          64    // Pending samples (power of two)
+#define SAMPLER_TASK_CORE          0    // ESP32: Arduino loop runs on core 1
+#define SAMPLER_TASK_PRIORITY      3
+#define SENSOR_TRACE_SERIAL        0    // 1 = print each reading as a CSV trace line
+#define LATENCY_REPORT_MS          0    // Print latency histograms this often (0 = on demand)
+#define TRANSITION_REPORT_SERIAL   0    // 1 = print each breath state change (from the detect task)
+
+// ========================================
+// Filtering
+// ========================================
+// Software low-pass between the Sampler and BreathData
+#define FILTER_ENABLED             1
+#define FILTER_CUTOFF_HZ           4.0f  // Butterworth biquad cascade corner
+#define FILTER_BIQUAD_SECTIONS     2     // 2 sections = 4th order
+#define FILTER_FIR_TAPS            9     // Windowed-sinc FIR length (odd)
+#define FILTER_FIR_CUTOFF_HZ       6.0f
+#define FILTER_BLOCK_SIZE          SAMPLE_RING_SIZE  // Samples per filter pass
+
+// ========================================
+// Session Storage
+// ========================================
+// Finished-session summaries, queued in RAM and appended to flash by
+// the storage task (see SessionLog.h)
+#define SESSION_IDLE_TIMEOUT_MS   60000  // No breath for this long ends the session
+#define SESSION_MIN_BREATHS        3     // Shorter sessions are not stored
+#define SESSION_QUEUE_SIZE         8     // Summaries waiting for flash (power of two)
+#define SESSION_LOG_SECTORS        8     // 4 KB sectors in the log ring (128 records each)
+#define STORAGE_FLUSH_PERIOD_MS  1000
+#define STORAGE_TASK_CORE          1     // ESP32: beside loop(), which sleeps between frames
+#define STORAGE_TASK_PRIORITY      0     // Idle priority: flushes in idle time only
+
+// ========================================
+// Settings
+// ========================================
+// Every persistent setting in one versioned record, read once at boot
+// and committed by the storage task (see Settings.h)
+#define SETTINGS_VERSION           1
+#define SETTINGS_QUIET_MS        5000   // Commit once settings stop changing this long
+#define SETTINGS_MAX_DEFER_MS   60000   // ...or this long after the first change at most
 
 #endif // CONFIG_H
@@ -1,3 +1,5 @@
+#include <atomic>
+
 #ifdef SIMULATOR
   #include "Platform.h"
 #else
@@ -7,11 +9,23 @@
 #include "config.h"
 #include "BreathData.h"
 #include "Display.h"
+#include "HudText.h"
+#include "LatencyTrace.h"
+#include "PressureFilter.h"
+#include "Sampler.h"
+#include "Scheduler.h"
 #include "Sensor.h"
+#include "SensorProfile.h"
+#include "SessionLog.h"
+#include "Settings.h"
 #include "Storage.h"
 #include "modes/live_mode.h"
 #include "modes/diagnostic_mode.h"
 
+#ifdef SIMULATOR
+  #include "Options.h"
+#endif
+
 // ========================================
 // Global Application State
 // ========================================
@@ -22,8 +36,245 @@ SerialMock Serial;
 AppMode currentMode = MODE_LIVE;
 BreathData breathData;
 Display display;
+GlyphAtlas glyphAtlas;
 Sensor pressureSensor;
+Sampler sampler;
+PressureFilter pressureFilter;
+LatencyTrace latencyTrace;
+Scheduler scheduler("render");
+Scheduler detectScheduler("detect");
+Scheduler storageScheduler("storage");
 Storage storage;
+SessionLog sessionLog;
+SettingsStore settingsStore;
+
+// ========================================
+// Sensor Profiles
+// ========================================
+// Switch to the next sensor profile without recalibrating the baseline
+void cycleSensorProfile() {
+  SensorProfile next = (SensorProfile)((pressureSensor.getProfile() + 1) % SENSOR_PROFILE_COUNT);
+  sampler.pause();
+  pressureSensor.setProfile(next);
+  sampler.resume();
+}
+
+// Measure output data rate, step delay and noise of every profile
+void measureSensorProfiles() {
+  display.showMessage("Measuring\n  sensor profiles\n  keep still...", ST77XX_YELLOW);
+  sampler.pause();
+  reportSensorProfiles(pressureSensor);
+  sampler.resume();
+}
+
+// ========================================
+// Settings
+// ========================================
+// Apply the settings loaded at boot (before the sampler and detection start)
+static void applySettings(const Settings& settings) {
+  breathData.inhaleThreshold = settings.inhaleThreshold;
+  breathData.exhaleThreshold = settings.exhaleThreshold;
+  breathData.setCalibration(settings.minDelta, settings.maxDelta);
+  pressureSensor.setProfile((SensorProfile)settings.sensorProfile);
+  currentMode = (AppMode)settings.mode;
+}
+
+// Hand the current settings to the store (render side, every frame).
+// Only changes go further; the storage task commits them once settled.
+// The boot mode is not taken from currentMode: only toggleMode() stores
+// it, so automatic mode switches (headless --mode) never reach flash.
+static void updateSettings(const BreathSnapshot& breath) {
+  Settings settings = settingsStore.get();
+  settings.inhaleThreshold = breathData.inhaleThreshold;
+  settings.exhaleThreshold = breathData.exhaleThreshold;
+  settings.sensorProfile = (uint8_t)pressureSensor.getProfile();
+  if (breath.hasSample) {
+    settings.minDelta = breath.minDelta;
+    settings.maxDelta = breath.maxDelta;
+  }
+  settingsStore.update(settings);
+}
+
+// Switch modes at the user's request (render side); the mode is stored
+// as the one to show at boot
+void toggleMode() {
+  currentMode = (currentMode == MODE_LIVE) ? MODE_DIAGNOSTIC : MODE_LIVE;
+  Serial.print("Mode: ");
+  Serial.println(currentMode == MODE_LIVE ? "LIVE" : "DIAGNOSTIC");
+
+  Settings settings = settingsStore.get();
+  settings.mode = (uint8_t)currentMode;
+  settingsStore.update(settings);
+}
+
+#if TRANSITION_REPORT_SERIAL
+// ========================================
+// Breath Transitions
+// ========================================
+// State changes found in one block of samples
+static const size_t MAX_TRANSITIONS_PER_BLOCK = 8;
+
+// Log state changes with their sample times (debugging only: this is
+// serial output from the detect task)
+void reportTransitions(const BreathTransition* transitions, size_t count) {
+  static const char* const names[] = { "IDLE", "INHALE", "EXHALE", "HOLD" };
+  for (size_t i = 0; i < count; i++) {
+    Serial.print((unsigned)transitions[i].timestamp);
+    Serial.print(" ms: ");
+    Serial.print(names[transitions[i].from]);
+    Serial.print(" -> ");
+    Serial.println(names[transitions[i].to]);
+  }
+}
+#endif
+
+// ========================================
+// Sessions
+// ========================================
+// End the session and queue its summary for flash (detection side). A
+// full queue drops the summary rather than wait for the storage task.
+static void endSession() {
+  SessionSummary summary;
+  if (breathData.finishSession(summary)) sessionLog.enqueue(summary);
+}
+
+// ========================================
+// Detection-Side Requests
+// ========================================
+// Reports and actions on detection-owned state are requested from the
+// render side (serial, keys) and run by the detection task between passes.
+// Each request is a bit, so requests made between two passes all run.
+enum DetectionRequest {
+  REQUEST_NONE             = 0,
+  REQUEST_SESSION_STATS    = 1 << 0,
+  REQUEST_BREATH_LOG       = 1 << 1,
+  REQUEST_DETECT_SCHEDULER = 1 << 2,
+  REQUEST_END_SESSION      = 1 << 3,
+  REQUEST_RESET_BOUNDS     = 1 << 4
+};
+
+static std::atomic<unsigned> pendingRequests{REQUEST_NONE};
+
+void requestDetection(DetectionRequest request) {
+  pendingRequests.fetch_or(request);
+}
+
+static void runPendingRequests() {
+  unsigned requests = pendingRequests.exchange(REQUEST_NONE);
+  if (requests & REQUEST_SESSION_STATS) reportSessionStats(breathData.getSessionStats());
+  if (requests & REQUEST_BREATH_LOG) dumpBreathLog(breathData.getBreathLog());
+  if (requests & REQUEST_DETECT_SCHEDULER) detectScheduler.report();
+  if (requests & REQUEST_END_SESSION) endSession();
+  if (requests & REQUEST_RESET_BOUNDS) {
+    // The next snapshot carries the default bounds, and the render task
+    // hands them to settingsStore like any other change
+    breathData.resetCalibration();
+    Serial.println("Calibration bounds reset");
+  }
+}
+
+// The storage task prints its own scheduler's table
+static std::atomic<bool> storageSchedulerReport{false};
+
+// Every scheduler's task table
+void reportSchedulers() {
+  scheduler.report();
+  requestDetection(REQUEST_DETECT_SCHEDULER);
+  storageSchedulerReport.store(true);
+}
+
+// ========================================
+// Periodic Tasks
+// ========================================
+static int renderTaskId = -1;
+
+// Render period of a mode
+static uint32_t renderPeriodMicros(AppMode mode) {
+  return 1000000UL / (mode == MODE_LIVE ? WAVE_UPDATE_FPS : DIAGNOSTIC_UPDATE_FPS);
+}
+
+// Drain samples captured since the last run, filter them as a block,
+// detect breath state with each sample's own timestamp and publish a
+// snapshot for the render side (detection core)
+void detectTask(uint32_t) {
+  Sample samples[FILTER_BLOCK_SIZE];
+  float deltas[FILTER_BLOCK_SIZE];
+  size_t count;
+  bool sampled = false;
+  unsigned long newestTimestamp = 0;
+  do {
+    count = 0;
+    while (count < FILTER_BLOCK_SIZE && sampler.read(samples[count])) {
+      deltas[count] = samples[count].pressureDelta;
+      count++;
+    }
+    if (count == 0) break;
+
+#if FILTER_ENABLED
+    pressureFilter.process(deltas, count);
+    for (size_t i = 0; i < count; i++) {
+      samples[i].pressureDelta = deltas[i];
+    }
+#endif
+#if TRANSITION_REPORT_SERIAL
+    BreathTransition transitions[MAX_TRANSITIONS_PER_BLOCK];
+    size_t found = breathData.detectBlock(samples, count, transitions, MAX_TRANSITIONS_PER_BLOCK);
+    if (found > MAX_TRANSITIONS_PER_BLOCK) found = MAX_TRANSITIONS_PER_BLOCK;
+    reportTransitions(transitions, found);
+#else
+    breathData.detectBlock(samples, count);
+#endif
+    breathData.publishSnapshot(samples[count - 1]);
+    sampled = true;
+    newestTimestamp = samples[count - 1].timestamp;
+  } while (count == FILTER_BLOCK_SIZE);
+
+  // Breathing has stopped for a while: the session is over. Measured on
+  // the samples' timeline, which breath times come from (the clock runs
+  // ahead of it when samples queue up or a trace is replayed --fast).
+  if (sampled && breathData.isSessionIdle(newestTimestamp)) endSession();
+
+  runPendingRequests();
+}
+
+// Draw the current mode from the newest breath snapshot (render core)
+void renderTask(uint32_t elapsedMicros) {
+  const BreathSnapshot& breath = breathData.readSnapshot();
+  if (breath.hasSample) {
+    latencyTrace.noteSample(breath.captureMicros, breath.readMicros, breath.detectMicros);
+  }
+
+  latencyTrace.mark(LATENCY_RENDER);
+  switch (currentMode) {
+    case MODE_LIVE:
+      drawLiveMode(breath, elapsedMicros / 1000000.0f);
+      break;
+
+    case MODE_DIAGNOSTIC:
+      drawDiagnosticMode(breath);
+      break;
+  }
+
+  // Follow mode switches from the next frame
+  scheduler.setPeriod(renderTaskId, renderPeriodMicros(currentMode));
+
+  updateSettings(breath);
+}
+
+// Write queued session summaries and settled settings to flash
+// (storage task, idle priority)
+void storageTask(uint32_t) {
+  sessionLog.flush();
+  settingsStore.commitIfQuiet(millis());
+  if (storageSchedulerReport.exchange(false)) storageScheduler.report();
+}
+
+#if LATENCY_REPORT_MS > 0
+void latencyReportTask(uint32_t) {
+  latencyTrace.report();
+  latencyTrace.reset();
+}
+#endif
 
 // ========================================
 // Setup
@@ -31,12 +282,24 @@ Storage storage;
 void setup() {
   Serial.begin(115200);
 
-#ifdef SIMULATOR
+#if defined(HEADLESS)
+  Serial.println("Inhale Simulator (headless)");
+  Serial.println("===========================");
+#elif defined(SIMULATOR)
   Serial.println("Inhale Simulator");
   Serial.println("================");
   Serial.println("Controls:");
   Serial.println("  Mouse Y: Breath pressure (up=exhale, down=inhale)");
   Serial.println("  Space: Toggle mode (Live/Diagnostic)");
+  Serial.println("  P: Next sensor profile");
+  Serial.println("  M: Measure sensor profiles");
+  Serial.println("  S: Print session statistics");
+  Serial.println("  L: Print the breath log (CSV)");
+  Serial.println("  T: Print sensor-to-display latency");
+  Serial.println("  R: Print scheduler task timing");
+  Serial.println("  E: End the session (store its summary)");
+  Serial.println("  H: Print stored session summaries");
+  Serial.println("  C: Reset the calibration bounds");
   Serial.println("  ESC/Q: Quit");
   Serial.println("");
 
@@ -49,20 +312,47 @@ void setup() {
   delay(1000);
   Serial.println("Inhale - Breath Visualization Device");
   Serial.println("====================================");
+  Serial.println("Serial commands: p = next sensor profile, m = measure profiles, s = session stats, l = breath log, t = latency, r = scheduler, e = end session, h = session history, c = reset bounds");
 #endif
 
   // Initialize components (sensor first to avoid I2C conflicts)
   pressureSensor.init();
   display.init();
+  glyphAtlas.init();
   storage.init();
+  sessionLog.init();
   breathData.init();
+  latencyTrace.reset();
 
-  // Load calibration from storage
-  storage.loadCalibration(breathData.inhaleThreshold, breathData.exhaleThreshold);
+  // Load settings from storage (one record, read once)
+  applySettings(settingsStore.load());
 
   // Calibrate baseline
   pressureSensor.calibrateBaseline();
 
+  pressureFilter.init(1000.0f / SAMPLE_PERIOD_MS);
+  Serial.print("Pressure filter delay: ");
+  Serial.print(pressureFilter.getDelayMs(), 0);
+  Serial.println(" ms");
+
+  // Hand the sensor over to the sampling task
+#ifdef SIMULATOR
+  sampler.start(pressureSensor.isFreeRunning() ? 0 : SAMPLE_PERIOD_MS);
+#else
+  sampler.start(SAMPLE_PERIOD_MS);
+#endif
+
+  // Periodic tasks on a fixed release grid: detection on its own core,
+  // rendering (and the latency report) in loop() on the other
+  detectScheduler.addTask("detect", detectTask, DETECT_PERIOD_MS * 1000UL);
+  detectScheduler.startTask(DETECT_TASK_CORE, DETECT_TASK_PRIORITY);
+  storageScheduler.addTask("flush", storageTask, STORAGE_FLUSH_PERIOD_MS * 1000UL);
+  storageScheduler.startTask(STORAGE_TASK_CORE, STORAGE_TASK_PRIORITY);
+  renderTaskId = scheduler.addTask("render", renderTask, renderPeriodMicros(currentMode));
+#if LATENCY_REPORT_MS > 0
+  scheduler.addTask("latency", latencyReportTask, LATENCY_REPORT_MS * 1000UL);
+#endif
+
   Serial.println("System ready!");
 }
 
@@ -70,39 +360,48 @@ void setup() {
 // Main Loop
 // ========================================
 void loop() {
-  // Update sensor readings
-  pressureSensor.update();
-  float pressureDelta = pressureSensor.getDelta();
-
-  // Detect breath state
-  breathData.detect(pressureDelta);
-
-  // Update display based on current mode
-  switch (currentMode) {
-    case MODE_LIVE:
-      drawLiveMode(pressureDelta);
-      break;
-
-    case MODE_DIAGNOSTIC:
-      drawDiagnosticMode(pressureDelta);
-      break;
+#ifndef SIMULATOR
+  // Serial commands
+  while (Serial.available()) {
+    switch (Serial.read()) {
+      case 'p': cycleSensorProfile(); break;
+      case 'm': measureSensorProfiles(); break;
+      case 's': requestDetection(REQUEST_SESSION_STATS); break;
+      case 'l': requestDetection(REQUEST_BREATH_LOG); break;
+      case 't': latencyTrace.report(); break;
+      case 'r': reportSchedulers(); break;
+      case 'e': requestDetection(REQUEST_END_SESSION); break;
+      case 'h': sessionLog.requestReport(); break;
+      case 'c': requestDetection(REQUEST_RESET_BOUNDS); break;
+    }
   }
+#endif
+
+#ifdef HEADLESS
+  // No threads: detection and storage run on the virtual clock here too
+  detectScheduler.runDue();
+  storageScheduler.runDue();
+#endif
+  scheduler.runDue();
 
 #ifndef SIMULATOR
-  delay(MAIN_LOOP_DELAY_MS);
+  // Sleep until the next task is due (the simulators call loop() every ms)
+  scheduler.sleepUntilNextRelease();
 #endif
 }
 
 // ========================================
 // Simulator Entry Point
 // ========================================
-#ifdef SIMULATOR
+#if defined(SIMULATOR) && !defined(HEADLESS)
 int main(int argc, char* argv[]) {
+  SimulatorOptions options;
+  if (!parseSimulatorArgs(argc, argv, options)) return 1;
+
   setup();
 
   bool running = true;
   SDL_Event event;
-  uint32_t lastLoopTime = 0;
 
   while (running) {
     while (SDL_PollEvent(&event)) {
@@ -118,9 +417,34 @@ int main(int argc, char* argv[]) {
               running = false;
               break;
             case SDLK_SPACE:
-              currentMode = (currentMode == MODE_LIVE) ? MODE_DIAGNOSTIC : MODE_LIVE;
-              Serial.print("Mode: ");
-              Serial.println(currentMode == MODE_LIVE ? "LIVE" : "DIAGNOSTIC");
+              toggleMode();
+              break;
+            case SDLK_p:
+              cycleSensorProfile();
+              break;
+            case SDLK_m:
+              measureSensorProfiles();
+              break;
+            case SDLK_s:
+              requestDetection(REQUEST_SESSION_STATS);
+              break;
+            case SDLK_l:
+              requestDetection(REQUEST_BREATH_LOG);
+              break;
+            case SDLK_t:
+              latencyTrace.report();
+              break;
+            case SDLK_r:
+              reportSchedulers();
+              break;
+            case SDLK_e:
+              requestDetection(REQUEST_END_SESSION);
+              break;
+            case SDLK_h:
+              sessionLog.requestReport();
+              break;
+            case SDLK_c:
+              requestDetection(REQUEST_RESET_BOUNDS);
               break;
           }
           break;
@@ -131,11 +455,14 @@ int main(int argc, char* argv[]) {
       }
     }
 
-    // Run main loop at ~50Hz
-    uint32_t now = millis();
-    if (now - lastLoopTime >= MAIN_LOOP_DELAY_MS) {
-      lastLoopTime = now;
-      loop();
+    // Run whichever tasks are due
+    loop();
+
+    // Stop once a replayed trace has been fully consumed
+    if (pressureSensor.isTraceFinished() && sampler.available() == 0) {
+      Serial.print("Trace finished - breaths: ");
+      Serial.println(breathData.readSnapshot().breathCount);
+      running = false;
     }
 
     SDL_Delay(1);
@@ -2,45 +2,77 @@
 #include "../config.h"
 #include "../BreathData.h"
 #include "../Display.h"
-#include "../Sensor.h"
+#include "../HudText.h"
+#include "../Raster.h"
 
-void drawDiagnosticMode(float pressureDelta) {
-  static unsigned long lastUpdate = 0;
+// Canvas pixel values of the mode's colors, and the palette they index
+struct DiagnosticColors {
+  Palette palette;
+  Pixel black, white, gray, yellow, cyan, magenta, green, orange;
+};
 
-  unsigned long now = millis();
-  if (now - lastUpdate < 100) return;  // 10 FPS
-  lastUpdate = now;
+static constexpr DiagnosticColors makeDiagnosticColors() {
+  DiagnosticColors colors = {};
+  colors.black = colors.palette.pixel(ST77XX_BLACK);
+  colors.white = colors.palette.pixel(ST77XX_WHITE);
+  colors.gray = colors.palette.pixel(ST77XX_GRAY);
+  colors.yellow = colors.palette.pixel(ST77XX_YELLOW);
+  colors.cyan = colors.palette.pixel(ST77XX_CYAN);
+  colors.magenta = colors.palette.pixel(ST77XX_MAGENTA);
+  colors.green = colors.palette.pixel(ST77XX_GREEN);
+  colors.orange = colors.palette.pixel(ST77XX_ORANGE);
+  return colors;
+}
+
+static constexpr DiagnosticColors diagnosticColors = makeDiagnosticColors();
+static_assert(!diagnosticColors.palette.overflow, "Diagnostic mode uses more than PALETTE_SIZE colors");
+
+// Readings of the frame being drawn (the scene runs once per strip)
+static BreathSnapshot frame;
 
-  Canvas& canvas = display.getCanvas();
-  canvas.fillScreen(ST77XX_BLACK);
+static void drawDiagnosticScene(FrameCanvas& canvas) {
+  Raster raster(canvas);
+  HudText text(canvas);
+  raster.fill(diagnosticColors.black);
 
   // Title
-  canvas.setCursor(10, 5);
-  canvas.setTextColor(ST77XX_YELLOW);
-  canvas.setTextSize(1);
-  canvas.println("DIAGNOSTIC MODE");
+  text.setCursor(10, 5);
+  text.setTextColor(diagnosticColors.yellow);
+  text.setTextSize(1);
+  text.println("DIAGNOSTIC MODE");
 
   // Pressure delta
-  canvas.setCursor(10, 22);
-  canvas.setTextColor(ST77XX_WHITE);
-  canvas.setTextSize(1);
-  canvas.print("Delta: ");
-  if (pressureDelta >= 0) {
-    canvas.setTextColor(ST77XX_CYAN);
-    canvas.print("+");
+  text.setCursor(10, 22);
+  text.setTextColor(diagnosticColors.white);
+  text.setTextSize(1);
+  text.print("Delta: ");
+  if (frame.pressureDelta >= 0) {
+    text.setTextColor(diagnosticColors.cyan);
+    text.print("+");
   } else {
-    canvas.setTextColor(ST77XX_MAGENTA);
+    text.setTextColor(diagnosticColors.magenta);
   }
-  canvas.print(pressureDelta, 2);
-  canvas.print(" Pa");
+  text.print(frame.pressureDelta, 2);
+  text.print(" Pa");
 
   // Normalized value
-  float normalized = breathData.getNormalizedBreath();
-  canvas.setCursor(10, 36);
-  canvas.setTextColor(ST77XX_WHITE);
-  canvas.print("Norm: ");
-  canvas.setTextColor(normalized >= 0 ? ST77XX_CYAN : ST77XX_MAGENTA);
-  canvas.print(normalized, 2);
+  float normalized = frame.normalized;
+  text.setCursor(10, 36);
+  text.setTextColor(diagnosticColors.white);
+  text.print("Norm: ");
+  text.setTextColor(normalized >= 0 ? diagnosticColors.cyan : diagnosticColors.magenta);
+  text.print(normalized, 2);
+
+  // Breathing rate (right of the normalized value)
+  text.setCursor(80, 36);
+  if (frame.rateConfidence >= RATE_MIN_CONFIDENCE) {
+    text.setTextColor(diagnosticColors.green);
+    text.print(frame.rate, 1);
+  } else {
+    text.setTextColor(diagnosticColors.gray);
+    text.print("--");
+  }
+  text.print("bpm");
 
   // Draw normalized bar (-1 to +1)
   int barY = 54;
@@ -49,66 +81,70 @@ void drawDiagnosticMode(float pressureDelta) {
   int barWidth = abs(normalized) * maxBarWidth;
 
   // Check if bounds are being pushed (exceeds overage threshold)
-  float minDelta = breathData.getMinDelta();
-  float maxDelta = breathData.getMaxDelta();
-  bool pushingMin = pressureDelta < minDelta * NORM_OVERAGE_THRESHOLD && minDelta < -0.1f;
-  bool pushingMax = pressureDelta > maxDelta * NORM_OVERAGE_THRESHOLD && maxDelta > 0.1f;
+  float minDelta = frame.minDelta;
+  float maxDelta = frame.maxDelta;
+  bool pushingMin = frame.pressureDelta < minDelta * NORM_OVERAGE_THRESHOLD;
+  bool pushingMax = frame.pressureDelta > maxDelta * NORM_OVERAGE_THRESHOLD;
 
-  canvas.drawFastHLine(10, barY, SCREEN_WIDTH - 20, ST77XX_GRAY);
-  canvas.drawFastVLine(barCenter, barY - 5, 10, ST77XX_WHITE);
+  raster.fillRow(barY, 10, SCREEN_WIDTH - 10, diagnosticColors.gray);
+  raster.fillColumn(barCenter, barY - 5, barY + 5, diagnosticColors.white);
 
   if (normalized > 0) {
-    canvas.fillRect(barCenter, barY - 3, barWidth, 6, ST77XX_CYAN);
+    raster.fillRect(barCenter, barY - 3, barWidth, 6, diagnosticColors.cyan);
     // Draw arrow if pushing max
     if (pushingMax) {
       int arrowX = barCenter + barWidth;
-      canvas.fillTriangle(arrowX, barY - 5, arrowX, barY + 5, arrowX + 6, barY, ST77XX_WHITE);
+      canvas.fillTriangle(arrowX, barY - 5, arrowX, barY + 5, arrowX + 6, barY, diagnosticColors.white);
     }
   } else {
-    canvas.fillRect(barCenter - barWidth, barY - 3, barWidth, 6, ST77XX_MAGENTA);
+    raster.fillRect(barCenter - barWidth, barY - 3, barWidth, 6, diagnosticColors.magenta);
     // Draw arrow if pushing min
     if (pushingMin) {
       int arrowX = barCenter - barWidth;
-      canvas.fillTriangle(arrowX, barY - 5, arrowX, barY + 5, arrowX - 6, barY, ST77XX_WHITE);
+      canvas.fillTriangle(arrowX, barY - 5, arrowX, barY + 5, arrowX - 6, barY, diagnosticColors.white);
     }
   }
 
   // Absolute pressure in inHg
-  canvas.setCursor(10, 68);
-  canvas.setTextColor(ST77XX_WHITE);
-  canvas.setTextSize(1);
-  canvas.print("Pressure:");
-
-  canvas.setCursor(10, 80);
-  canvas.setTextSize(2);
-  canvas.setTextColor(ST77XX_GREEN);
-  float pressureInHg = pressureSensor.getAbsolutePressure() / 3386.39;  // Pa to inHg
-  canvas.print(pressureInHg, 3);
-  canvas.setTextSize(1);
-  canvas.print(" inHg");
+  text.setCursor(10, 68);
+  text.setTextColor(diagnosticColors.white);
+  text.setTextSize(1);
+  text.print("Pressure:");
+
+  text.setCursor(10, 80);
+  text.setTextSize(2);
+  text.setTextColor(diagnosticColors.green);
+  text.print(frame.pressure / 3386.39f, 3);  // Pa to inHg
+  text.setTextSize(1);
+  text.print(" inHg");
 
   // Temperature
-  canvas.setCursor(10, 100);
-  canvas.setTextColor(ST77XX_WHITE);
-  canvas.setTextSize(1);
-  canvas.print("Temp: ");
-  canvas.setTextColor(ST77XX_ORANGE);
-  float temp = pressureSensor.getTemperature();
-  canvas.print(temp, 1);
-  canvas.print("C ");
-  canvas.setTextColor(ST77XX_YELLOW);
+  text.setCursor(10, 100);
+  text.setTextColor(diagnosticColors.white);
+  text.setTextSize(1);
+  text.print("Temp: ");
+  text.setTextColor(diagnosticColors.orange);
+  float temp = frame.temperature;
+  text.print(temp, 1);
+  text.print("C ");
+  text.setTextColor(diagnosticColors.yellow);
   float tempF = temp * 9.0 / 5.0 + 32.0;
-  canvas.print(tempF, 1);
-  canvas.print("F");
+  text.print(tempF, 1);
+  text.print("F");
 
   // Calibration bounds
-  canvas.setCursor(10, 114);
-  canvas.setTextColor(ST77XX_GRAY);
-  canvas.print("Min:");
-  canvas.print(breathData.getMinDelta(), 0);
-  canvas.print(" Max:");
-  canvas.print(breathData.getMaxDelta(), 0);
-
-  // Blit canvas to display
-  display.blit();
+  text.setCursor(10, 114);
+  text.setTextColor(diagnosticColors.gray);
+  text.print("Min:");
+  text.print(frame.minDelta, 0);
+  text.print(" Max:");
+  text.print(frame.maxDelta, 0);
+}
+
+void drawDiagnosticMode(const BreathSnapshot& breath) {
+  frame = breath;
+
+  // Draw the scene strip by strip and send it to the display
+  display.setPalette(diagnosticColors.palette);
+  display.render(drawDiagnosticScene);
 }
@@ -1,7 +1,9 @@
 #ifndef DIAGNOSTIC_MODE_H
 #define DIAGNOSTIC_MODE_H
 
+#include "../BreathData.h"
+
 // Draw diagnostic display with pressure and temperature readings
-void drawDiagnosticMode(float pressureDelta);
+void drawDiagnosticMode(const BreathSnapshot& breath);
 
 #endif // DIAGNOSTIC_MODE_H
@@ -2,107 +2,214 @@
 #include "../config.h"
 #include "../BreathData.h"
 #include "../Display.h"
+#include "../HudText.h"
+#include "../Raster.h"
 #include <Arduino.h>
 
-void drawLiveMode(float pressureDelta) {
-  static unsigned long lastUpdate = 0;
-  static float wavePhase = 0;
-  static float targetWaveHeight = SCREEN_HEIGHT / 2;
-  static float currentWaveHeight = SCREEN_HEIGHT / 2;
+// ========================================
+// Precomputed Tables
+// ========================================
+
+// Wave colors (RGB565), indexed by BreathState
+struct WaveColors {
+  uint16_t water;
+  uint16_t foam;
+};
+
+static constexpr WaveColors waveColors[] = {
+  { Display::rgb565(0, 120, 180), Display::rgb565(120, 180, 255) },  // Idle: medium/sky blue
+  { Display::rgb565(0, 100, 200), Display::rgb565(100, 150, 255) },  // Inhale: deep/light blue
+  { Display::rgb565(0, 150, 200), Display::rgb565(150, 255, 255) },  // Exhale: cyan/bright cyan
+  { Display::rgb565(100, 0, 150), Display::rgb565(200, 100, 255) },  // Hold: purple/light purple
+};
+
+// Canvas pixel values of every color the mode draws, and the palette
+// they index (the sky's 128 rows quantize to a handful of RGB565 colors)
+struct WavePalette {
+  Pixel water;
+  Pixel foam;
+};
+
+struct LiveColors {
+  Palette palette;
+  Pixel sky[SCREEN_HEIGHT];  // Gradient: one color per row (map(y, 0, SCREEN_HEIGHT, 60, 20))
+  WavePalette waves[4];
+  Pixel text;
+};
+
+static constexpr LiveColors makeLiveColors() {
+  LiveColors colors = {};
+  for (int y = 0; y < SCREEN_HEIGHT; y++) {
+    uint8_t brightness = 60 + y * (20 - 60) / SCREEN_HEIGHT;
+    colors.sky[y] = colors.palette.pixel(Display::rgb565(brightness, brightness, brightness + 30));
+  }
+  for (int state = 0; state < 4; state++) {
+    colors.waves[state].water = colors.palette.pixel(waveColors[state].water);
+    colors.waves[state].foam = colors.palette.pixel(waveColors[state].foam);
+  }
+  colors.text = colors.palette.pixel(ST77XX_WHITE);
+  return colors;
+}
 
-  unsigned long now = millis();
-  if (now - lastUpdate < (1000 / WAVE_UPDATE_FPS)) return;
-  float dt = (now - lastUpdate) / 1000.0;
-  lastUpdate = now;
+static constexpr LiveColors liveColors = makeLiveColors();
+static_assert(!liveColors.palette.overflow, "Live mode uses more than PALETTE_SIZE colors");
+
+// Wave harmonics: spatial frequency (rad/px), phase speed multiplier and
+// amplitude (px). Angles are 32-bit fractions of a turn; the top
+// WAVE_TABLE_BITS index a sine table pre-scaled to Q8 pixels.
+#define WAVE_TABLE_BITS 8
+#define WAVE_TABLE_SIZE (1 << WAVE_TABLE_BITS)
+#define WAVE_HARMONICS  3
+
+struct WaveHarmonic {
+  float frequency;
+  float phaseSpeed;
+  float amplitude;
+};
+
+static const WaveHarmonic waveHarmonics[WAVE_HARMONICS] = {
+  { 0.15f,  1.0f, 8.0f },  // Primary wave (main surface)
+  { 0.08f,  1.3f, 5.0f },
+  { 0.22f, -0.7f, 3.0f },
+};
+
+static int16_t waveTables[WAVE_HARMONICS][WAVE_TABLE_SIZE];
+static uint32_t waveSteps[WAVE_HARMONICS];
+
+// Radians to a 32-bit fraction of a turn (wraps like the angle does)
+static uint32_t toTurns(float radians) {
+  float turns = radians / TWO_PI;
+  turns -= floorf(turns);
+  return (uint32_t)(turns * 4294967296.0);
+}
 
-  Canvas& canvas = display.getCanvas();
+static void buildWaveTables() {
+  for (int h = 0; h < WAVE_HARMONICS; h++) {
+    for (int i = 0; i < WAVE_TABLE_SIZE; i++) {
+      float angle = TWO_PI * i / WAVE_TABLE_SIZE;
+      waveTables[h][i] = (int16_t)lroundf(sinf(angle) * waveHarmonics[h].amplitude * 256.0f);
+    }
+    waveSteps[h] = toTurns(waveHarmonics[h].frequency);
+  }
+}
 
-  // Animate wave phase (horizontal scroll)
-  wavePhase += 2.5 * dt;
-  if (wavePhase > TWO_PI) wavePhase -= TWO_PI;
+// Computed once per frame by updateLiveWave(), drawn by the scene per strip
+struct LiveFrame {
+  int16_t waveY[SCREEN_WIDTH];       // Water surface per column
+  int8_t foamHeight[SCREEN_WIDTH];   // Crest above the surface
+  const WavePalette* palette;
+  BreathState state;
+  int breathCount;
+};
 
-  // Calculate target wave height based on normalized breath (-1 to +1)
-  // Exhale (positive) = wave rises (up), Inhale (negative) = wave drops (down)
-  float normalized = breathData.getNormalizedBreath();
-  float maxDisplacement = 50.0f;  // Max pixels from center
-  // Negate so exhale pushes wave up (lower Y), inhale pulls wave down (higher Y)
-  targetWaveHeight = (SCREEN_HEIGHT / 2) - (normalized * maxDisplacement);
+static LiveFrame frame;
 
-  // Smooth interpolation for organic movement
-  currentWaveHeight += (targetWaveHeight - currentWaveHeight) * 0.1;
-
-  // Determine wave colors based on breath state
-  uint16_t waterColor, foamColor;
-  switch (breathData.getState()) {
-    case BREATH_INHALE:
-      waterColor = Display::rgb565(0, 100, 200);    // Deep blue
-      foamColor = Display::rgb565(100, 150, 255);   // Light blue
-      break;
-    case BREATH_EXHALE:
-      waterColor = Display::rgb565(0, 150, 200);    // Cyan
-      foamColor = Display::rgb565(150, 255, 255);   // Bright cyan
-      break;
-    case BREATH_HOLD:
-      waterColor = Display::rgb565(100, 0, 150);    // Purple
-      foamColor = Display::rgb565(200, 100, 255);   // Light purple
-      break;
-    default:
-      waterColor = Display::rgb565(0, 120, 180);    // Medium blue
-      foamColor = Display::rgb565(120, 180, 255);   // Sky blue
-      break;
-  }
+static void drawLiveScene(FrameCanvas& canvas) {
+  // Bulk fills go straight to the strip buffer
+  Raster raster(canvas);
 
   // Draw sky gradient to canvas
   for (int y = 0; y < SCREEN_HEIGHT; y++) {
-    uint8_t brightness = map(y, 0, SCREEN_HEIGHT, 60, 20);
-    uint16_t skyColor = Display::rgb565(brightness, brightness, brightness + 30);
-    canvas.drawFastHLine(0, y, SCREEN_WIDTH, skyColor);
+    raster.fillRow(y, 0, SCREEN_WIDTH, liveColors.sky[y]);
   }
 
   // Draw multi-layer wave for depth to canvas
   for (int x = 0; x < SCREEN_WIDTH; x++) {
-    // Primary wave (main surface)
-    float wave1 = sin(x * 0.15 + wavePhase) * 8;
-    float wave2 = sin(x * 0.08 + wavePhase * 1.3) * 5;
-    float wave3 = sin(x * 0.22 - wavePhase * 0.7) * 3;
-
-    int waveY = (int)(currentWaveHeight + wave1 + wave2 + wave3);
-
-    // Clamp wave height
-    waveY = constrain(waveY, 10, SCREEN_HEIGHT - 10);
+    int waveY = frame.waveY[x];
 
     // Draw foam/crest (lighter color at wave peak)
-    int foamHeight = abs((int)wave1) / 2 + 2;
-    canvas.drawFastVLine(x, waveY - foamHeight, foamHeight, foamColor);
+    raster.fillColumn(x, waveY - frame.foamHeight[x], waveY, frame.palette->foam);
 
     // Draw water body below wave
-    canvas.drawFastVLine(x, waveY, SCREEN_HEIGHT - waveY, waterColor);
+    raster.fillColumn(x, waveY, SCREEN_HEIGHT, frame.palette->water);
   }
 
   // Draw HUD overlay to canvas
-  canvas.setCursor(4, 4);
-  canvas.setTextColor(ST77XX_WHITE);
-  canvas.setTextSize(1);
+  HudText text(canvas);
+  text.setCursor(4, 4);
+  text.setTextColor(liveColors.text);
+  text.setTextSize(1);
 
   // Mode indicator
-  canvas.print("LIVE");
+  text.print("LIVE");
 
   // Breath count
-  canvas.setCursor(4, SCREEN_HEIGHT - 10);
-  canvas.print("Breaths: ");
-  canvas.print(breathData.getBreathCount());
+  text.setCursor(4, SCREEN_HEIGHT - 10);
+  text.print("Breaths: ");
+  text.print(frame.breathCount);
 
   // Breath state indicator (top right)
   const char* stateText;
-  switch (breathData.getState()) {
+  switch (frame.state) {
     case BREATH_INHALE: stateText = "IN "; break;
     case BREATH_EXHALE: stateText = "OUT"; break;
     case BREATH_HOLD:   stateText = "HLD"; break;
     default:            stateText = "..."; break;
   }
-  canvas.setCursor(SCREEN_WIDTH - 22, 4);
-  canvas.print(stateText);
+  text.setCursor(SCREEN_WIDTH - 22, 4);
+  text.print(stateText);
+}
+
+void updateLiveWave(const BreathSnapshot& breath, float dt) {
+  static float wavePhase = 0;
+  static float targetWaveHeight = SCREEN_HEIGHT / 2;
+  static float currentWaveHeight = SCREEN_HEIGHT / 2;
+  static bool tablesBuilt = false;
+
+  if (!tablesBuilt) {
+    buildWaveTables();
+    tablesBuilt = true;
+  }
+
+  // Animate wave phase (horizontal scroll)
+  wavePhase += 2.5 * dt;
+  if (wavePhase > TWO_PI) wavePhase -= TWO_PI;
+
+  // Calculate target wave height based on normalized breath (-1 to +1)
+  // Exhale (positive) = wave rises (up), Inhale (negative) = wave drops (down)
+  float normalized = breath.normalized;
+  float maxDisplacement = 50.0f;  // Max pixels from center
+  // Negate so exhale pushes wave up (lower Y), inhale pulls wave down (higher Y)
+  targetWaveHeight = (SCREEN_HEIGHT / 2) - (normalized * maxDisplacement);
+
+  // Smooth interpolation for organic movement
+  currentWaveHeight += (targetWaveHeight - currentWaveHeight) * 0.1;
+
+  // Determine wave colors based on breath state
+  frame.state = breath.state;
+  frame.palette = &liveColors.waves[frame.state];
+  frame.breathCount = breath.breathCount;
+
+  // Angle of each harmonic at column 0
+  uint32_t angles[WAVE_HARMONICS];
+  for (int h = 0; h < WAVE_HARMONICS; h++) {
+    angles[h] = toTurns(wavePhase * waveHarmonics[h].phaseSpeed);
+  }
+  int32_t baseHeight = (int32_t)(currentWaveHeight * 256.0f);
+
+  // Wave surface per column
+  for (int x = 0; x < SCREEN_WIDTH; x++) {
+    int32_t wave1 = waveTables[0][angles[0] >> (32 - WAVE_TABLE_BITS)];
+    int32_t wave2 = waveTables[1][angles[1] >> (32 - WAVE_TABLE_BITS)];
+    int32_t wave3 = waveTables[2][angles[2] >> (32 - WAVE_TABLE_BITS)];
+    for (int h = 0; h < WAVE_HARMONICS; h++) {
+      angles[h] += waveSteps[h];
+    }
+
+    int waveY = (baseHeight + wave1 + wave2 + wave3) >> 8;
+
+    // Clamp wave height
+    frame.waveY[x] = constrain(waveY, 10, SCREEN_HEIGHT - 10);
+
+    // Foam/crest (lighter color at wave peak)
+    frame.foamHeight[x] = (abs(wave1) >> 8) / 2 + 2;
+  }
+}
+
+void drawLiveMode(const BreathSnapshot& breath, float dt) {
+  updateLiveWave(breath, dt);
 
-  // Blit canvas to display
-  display.blit();
+  // Draw the scene strip by strip and send it to the display
+  display.setPalette(liveColors.palette);
+  display.render(drawLiveScene);
 }
@@ -1,7 +1,13 @@
 #ifndef LIVE_MODE_H
 #define LIVE_MODE_H
 
-// Draw live wave visualization
-void drawLiveMode(float pressureDelta);
+#include "../BreathData.h"
+
+// Draw live wave visualization (dt: seconds since the previous frame)
+void drawLiveMode(const BreathSnapshot& breath, float dt);
+
+// Advance the wave and compute the frame's surface without drawing it
+// (the first half of drawLiveMode(); the benchmarks time it alone)
+void updateLiveWave(const BreathSnapshot& breath, float dt);
 
 #endif // LIVE_MODE_H